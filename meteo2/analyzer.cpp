@@ -1,5 +1,6 @@
 #include "analyzer.h"
 #include "types.h"
+#include "trajectory.h"
 
 #include <cmath>
 #include <QtMath>
@@ -9,50 +10,26 @@
 #include <vector>
 #include <algorithm>
 
-const Coordinate* Analyzer::findClosest(double h,const std::vector<Coordinate>& coords){
-    if (coords.empty())
-        return nullptr;
+void Analyzer::createZones(std::vector<Zone>& zones,const std::vector<Coordinate>& coordinates,const ZoneGrid& grid){
+    zones.reserve(zones.size() + grid.count());
 
-    const Coordinate* result = &coords[0];
-    double minDiff = std::abs(coords[0].H - h);
+    // границы зон идут по возрастанию - курсор траектории только продвигается
+    const Trajectory trajectory(coordinates);
 
-    for (const auto& c : coords)
+    grid.forEachHeight([&](double h)
     {
-        double diff = std::abs(c.H - h);
-        if (diff < minDiff)
-        {
-            minDiff = diff;
-            result = &c;
-        }
-    }
-
-    return result;
-}
+        Zone zone(h);
 
-void Analyzer::createZones(std::vector<Zone>& zones,const std::vector<Coordinate>& coordinates){
-    auto addZones = [&](double from, double to, double step)
-    {
-        for (double h = from; h < to; h += step)
+        if (!trajectory.isEmpty())
         {
-            Zone zone(h);
-            const Coordinate* closest = findClosest(h, coordinates);
-
-            if (closest)
-            {
-                zone.x = closest->X;
-                zone.z = closest->Z;
-                zone.s = closest->S;
-            }
-
-            zones.push_back(zone);
+            const Trajectory::Point p = trajectory.at(h);
+            zone.x = p.X;
+            zone.z = p.Z;
+            zone.s = p.S;
         }
-    };
 
-    //addZones(0.0,     500.0,   100.0);
-    addZones(100.0,     500.0,   100.0);
-    addZones(600.0,   6000.0,  200.0);
-    addZones(6000.0,  14000.0, 400.0);
-    addZones(14000.0, 20000.0, 500.0);
+        zones.push_back(zone);
+    });
 }
 
 void Analyzer::calculateDHmtd(std::vector<Mtd>& mtd){
@@ -97,6 +74,85 @@ void Analyzer::calculateVk(std::vector<Zone>& zones){
     }
 }
 
+void Analyzer::calculateVkLsq(std::vector<Zone>& zones, const std::vector<Coordinate>& coordinates){
+
+    // dh, y и значения по двум точкам
+    calculateVk(zones);
+
+    if (zones.size() < 2 || coordinates.empty())
+        return;
+
+    // суммы для регрессии по каждой зоне
+    struct Sums {
+        double n, t, tt, x, tx, xx, z, tz, zz;
+    };
+    std::vector<Sums> sums(zones.size(), Sums{});
+
+    // отсчет от первой точки, чтобы не терять точность в суммах квадратов
+    const double t0 = coordinates.front().S;
+    const double x0 = coordinates.front().X;
+    const double z0 = coordinates.front().Z;
+
+    for (const auto& c : coordinates)
+    {
+        // зона k - слой (height[k-1], height[k]]
+        auto it = std::lower_bound(zones.begin() + 1, zones.end(), c.H,
+                                   [](const Zone& zone, double h) { return zone.height < h; });
+        if (it == zones.end())
+            continue;
+
+        const size_t k = size_t(it - zones.begin());
+        if (c.H <= zones[k - 1].height)
+            continue;
+
+        const double t = (c.S - t0) * 0.1;
+        const double x = c.X - x0;
+        const double z = c.Z - z0;
+
+        Sums& s = sums[k];
+        s.n  += 1;
+        s.t  += t;
+        s.tt += t * t;
+        s.x  += x;
+        s.tx += t * x;
+        s.xx += x * x;
+        s.z  += z;
+        s.tz += t * z;
+        s.zz += z * z;
+    }
+
+    for (size_t k = 1; k < zones.size(); ++k)
+    {
+        const Sums& s = sums[k];
+        zones[k].nSamples = s.n;
+
+        const double stt = s.tt - s.t * s.t / s.n;
+        if (s.n < 3 || stt < EPS)
+        {
+            zones[k].vxErr = NAN;
+            zones[k].vzErr = NAN;
+            continue;
+        }
+
+        const double stx = s.tx - s.t * s.x / s.n;
+        const double stz = s.tz - s.t * s.z / s.n;
+        const double sxx = s.xx - s.x * s.x / s.n;
+        const double szz = s.zz - s.z * s.z / s.n;
+
+        const double vx = stx / stt;
+        const double vz = stz / stt;
+
+        // остаточная дисперсия -> СКО наклона
+        const double rx = std::max(sxx - vx * stx, 0.0) / (s.n - 2);
+        const double rz = std::max(szz - vz * stz, 0.0) / (s.n - 2);
+
+        zones[k].vx = vx;
+        zones[k].vz = vz;
+        zones[k].vxErr = std::sqrt(rx / stt);
+        zones[k].vzErr = std::sqrt(rz / stt);
+    }
+}
+
 void Analyzer::calculateVm(const std::vector<Zone>& zones,std::vector<Mts>& mts){
     for (size_t m = 1; m < mts.size(); ++m){
         double sumX{};
@@ -230,6 +286,30 @@ void Analyzer::createBullutinMts(std::vector<Mts>& mts)
     }
 }
 
+double Analyzer::soundingTop(const std::vector<Zone>& zones,
+                             const std::vector<Coordinate>& coordinates,
+                             const std::vector<TemperatureRecord>& records)
+{
+    double maxHeight = coordinates.empty() ? INFINITY : -INFINITY;
+    for (const auto& c : coordinates)
+        maxHeight = std::max(maxHeight, c.H);
+
+    // зона i получает блок лога с index == i + 1, как в calculateTn
+    size_t blocks = records.empty() ? zones.size() : 0;
+    for (const auto& r : records)
+        blocks = std::max(blocks, size_t(std::max(r.index, 0)));
+
+    double top = -INFINITY;
+    for (size_t i = 0; i < zones.size() && i < blocks; ++i)
+    {
+        if (zones[i].height > maxHeight)
+            break;
+        top = zones[i].height;
+    }
+
+    return top;
+}
+
 void Analyzer::calculateT(std::vector<TemperatureRecord>& records, UserConstants globalParam){
     for(auto& r : records){
         if (std::abs(r.QT) < EPS)
@@ -244,32 +324,15 @@ void Analyzer::calculateT(std::vector<TemperatureRecord>& records, UserConstants
     }
 }
 
-void Analyzer::createZones(std::vector<Zone>& Zones)
+void Analyzer::createZones(std::vector<Zone>& Zones,const ZoneGrid& grid)
 {
     Zones.clear();
+    Zones.reserve(grid.count());
 
-    auto addZones = [&](double from, double to, double step)
+    grid.forEachHeight([&](double h)
     {
-        for (double h = from; h < to; h += step)
-        {
-            Zones.emplace_back(h);
-        }
-    };
-
-    // первая зона
-    Zones.emplace_back(0.0);
-
-    // до 500 м — шаг 100
-    addZones(100.0, 500.0, 100.0);
-
-    // 500–6000 м — шаг 200 (начинаем с 600)
-    addZones(600.0, 6000.0, 200.0);
-
-    // 6000–14000 м — шаг 400
-    addZones(6000.0, 14000.0, 400.0);
-
-    // 14000–20000 м — шаг 500
-    addZones(14000.0, 50001.0, 500.0);
+        Zones.emplace_back(h);
+    });
 }
 
 void Analyzer::calculateMediumHeight(std::vector<Zone>& Zones)
@@ -280,6 +343,25 @@ void Analyzer::calculateMediumHeight(std::vector<Zone>& Zones)
     }
 }
 
+void Analyzer::calculateRadiation(std::vector<TemperatureRecord>& records, const std::vector<Zone>& zones,
+                                  const RadiationTable& table, double sunElevation){
+
+    // середины зон, как в calculateMediumHeight; нулевая зона - у земли
+    std::vector<double> heights(zones.size());
+    for (size_t i = 0; i < zones.size(); ++i)
+        heights[i] = (i == 0) ? zones[0].height : (zones[i - 1].height + zones[i].height) / 2.0;
+
+    // одна высота солнца на зондирование: таблица интерполируется по зонам,
+    // записи получают поправку своей зоны
+    std::vector<double> dtp(zones.size());
+    table.profile(sunElevation, heights.data(), dtp.data(), heights.size());
+
+    for (auto& rec : records){
+        size_t zone = static_cast<size_t>(rec.index - 1);
+        rec.dtp = (rec.index >= 1 && zone < dtp.size()) ? dtp[zone] : 0.0;
+    }
+}
+
 void Analyzer::addRadio(std::vector<TemperatureRecord>& records){
     for (auto& rec : records){
         rec.T1 = rec.T + rec.dtp;
@@ -293,47 +375,144 @@ void Analyzer::addVir(std::vector<Zone>& Zones){
     }
 }
 
-// Метод для вычисления средних температур по индексам
+// Метод для вычисления средних температур (и влажности, если она есть) по индексам
 void Analyzer::calculateTn(const std::vector<TemperatureRecord>& records,std::vector<Zone>& Zones)
 {
-    // Словарь: key = индекс, value = пара (сумма T, количество записей)
-    std::unordered_map<int, std::pair<double, int>> sumCount;
+    // суммы по индексу зоны: температура и измеренная влажность
+    struct Sum {
+        double t = 0.0;
+        int n = 0;
+        double u = 0.0;
+        int nu = 0;
+    };
 
-    // 1. Просуммировать T по index
+    std::unordered_map<int, Sum> sums;
+
+    // 1. Просуммировать T и U по index за один проход
     for (const auto& rec : records) {
-        sumCount[rec.index].first += rec.T1;  // сумма T
-        sumCount[rec.index].second += 1;    // количество записей
+        Sum& sum = sums[rec.index];
+        sum.t += rec.T1;
+        sum.n += 1;
+
+        if (!std::isnan(rec.U)) {
+            sum.u += rec.U;
+            sum.nu += 1;
+        }
     }
 
     // 2. Записать средние значения в Zones по порядку
     for (size_t i = 0; i < Zones.size(); ++i) {
         int idx = static_cast<int>(i + 1); // если индексы начинаются с 1
-        if (sumCount.find(idx) != sumCount.end() && sumCount[idx].second != 0) {
-            Zones[i].Tn = sumCount[idx].first / sumCount[idx].second;
+        auto it = sums.find(idx);
+
+        if (it != sums.end() && it->second.n != 0) {
+            Zones[i].Tn = it->second.t / it->second.n;
         } else {
             Zones[i].Tn = 0.0; // или другое значение по умолчанию
         }
+
+        Zones[i].Un = (it != sums.end() && it->second.nu != 0) ? it->second.u / it->second.nu : NAN;
     }
 }
 
-void Analyzer::calculateDTvir(std::vector<Zone>& Zones, UserConstants globalParam){
+void Analyzer::groupSamples(const std::vector<TemperatureRecord>& records, size_t zoneCount, ZoneSamples& samples)
+{
+    // зона i получает измерения с index == i + 1, как в calculateTn
+    std::vector<size_t> count(zoneCount, 0);
+    std::vector<double> dtpSum(zoneCount, 0.0);
+    std::vector<size_t> uCount(zoneCount, 0);
+    std::vector<double> uSum(zoneCount, 0.0);
 
+    for (const auto& rec : records) {
+        size_t zone = static_cast<size_t>(rec.index - 1);
+        if (rec.index >= 1 && zone < zoneCount) {
+            count[zone]++;
+            dtpSum[zone] += rec.dtp;
+
+            if (!std::isnan(rec.U)) {
+                uCount[zone]++;
+                uSum[zone] += rec.U;
+            }
+        }
+    }
 
-    for (size_t i = 1; i < Zones.size(); ++i)
-    {
-        double Hkm = Zones[i].Hi / 1000.0;
+    samples.offset.assign(zoneCount + 1, 0);
+    for (size_t i = 0; i < zoneCount; ++i)
+        samples.offset[i + 1] = samples.offset[i] + count[i];
+
+    samples.yt.assign(samples.offset[zoneCount], 0.0);
+    samples.dtpMean.assign(zoneCount, 0.0);
+    samples.uMean.assign(zoneCount, NAN);
+
+    for (size_t i = 0; i < zoneCount; ++i) {
+        if (count[i] != 0)
+            samples.dtpMean[i] = dtpSum[i] / count[i];
+        if (uCount[i] != 0)
+            samples.uMean[i] = uSum[i] / uCount[i];
+    }
+
+    std::vector<size_t> pos(samples.offset.begin(), samples.offset.end() - 1);
+
+    for (const auto& rec : records) {
+        size_t zone = static_cast<size_t>(rec.index - 1);
+        if (rec.index < 1 || zone >= zoneCount)
+            continue;
+
+        // при QT == 0 calculateT не трогает запись, и T остается нулевой
+        samples.yt[pos[zone]++] = (std::abs(rec.QT) < EPS) ? NAN : rec.QO / rec.QT;
+    }
+}
+
+void Analyzer::calculateTnFast(const ZoneSamples& samples, const UserConstants& globalParam, std::vector<Zone>& Zones)
+{
+    // то же, что calculateT + addRadio + calculateTn, но без проходов по записям:
+    // среднее (T + dtp) = среднее T + средняя поправка зоны
+    const double lnScale = log(pow(10,3)) - log(globalParam.A);
+    const size_t zoneCount = std::min(Zones.size(), samples.dtpMean.size());
 
-        double x1 = (2.3 * (Zones[i].Tn + 273.15) * globalParam.U0) / (100 * globalParam.P0);
+    for (size_t i = 0; i < zoneCount; ++i) {
+        const size_t begin = samples.offset[i];
+        const size_t end = samples.offset[i + 1];
 
-        double x2 = std::exp(((310 * globalParam.T0) - std::pow(globalParam.T0, 2)) / 4300);
+        // влажность от констант не зависит - берется готовое среднее
+        Zones[i].Un = samples.uMean[i];
 
-        //double x3 = std::exp(-2.3 * (0.0947 * Tzones[i].Hi + 0.0138 * std::pow(Tzones[i].Hi,2)));
-        double x3 = std::exp(-2.3 * (0.0947 * Hkm + 0.0138 * std::pow(Hkm, 2)));
+        if (begin == end) {
+            Zones[i].Tn = 0.0;
+            continue;
+        }
+
+        double sumT = 0.0;
+        for (size_t k = begin; k < end; ++k) {
+            double Yt = samples.yt[k];
+            if (std::isnan(Yt))
+                continue;
+
+            double Rt = (globalParam.R1 / Yt) - globalParam.R2;
+            sumT += (globalParam.B / (lnScale + log(Rt))) - globalParam.C - 273.15;
+        }
 
-        Zones[i].dTvir = x1 * x2 * x3;
+        Zones[i].Tn = sumT / (end - begin) + samples.dtpMean[i];
+    }
+
+    for (size_t i = zoneCount; i < Zones.size(); ++i) {
+        Zones[i].Tn = 0.0;
+        Zones[i].Un = NAN;
     }
 }
 
+void Analyzer::calculateDTvir(std::vector<Zone>& Zones, UserConstants globalParam){
+    calculateDTvir(Zones, VirtualCorrection(globalParam));
+}
+
+void Analyzer::calculateDTvir(std::vector<Zone>& Zones, const VirtualCorrection& correction){
+    correction.apply(Zones);
+}
+
+double Analyzer::groundVirtualTemperature(UserConstants globalParam){
+    return VirtualCorrection(globalParam).groundTemperature();
+}
+
 
 void Analyzer::fillTabTemperature(const std::map<double, double>& temperatureTable,std::vector<Zone>& zones)
 {
@@ -384,13 +563,49 @@ void Analyzer::fillTabTemperature(const std::map<double, double>& temperatureTab
     }
 }
 
-void Analyzer::fillTabDensity(const std::map<double, double>& DensityTable,std::vector<Zone>& zones)
+// нормальная артиллерийская атмосфера (виртуальная температура):
+//   H <= 9300 м          - τ = 288.9 - 0.006328 H;
+//   9300 < H <= 12000 м  - τ = 230 - 0.006328 x + 0.000001172 x^2, x = H - 9300;
+//   H > 12000 м          - изотермия;
+// давление 1000 гПа у земли, ниже по барометрической формуле, по слоям точно
+double Analyzer::normalTemperature(double H)
 {
+    if (H <= 9300)
+        return 288.9 - 0.006328 * H;
 
-    if (DensityTable.empty())
-        return;
+    const double x = std::min(H, 12000.0) - 9300;
+    return 230 - 0.006328 * x + 0.000001172 * x * x;
+}
 
+double Analyzer::normalPressure(double H)
+{
+    static const double n = 1 / (29.27 * 0.006328);
+
+    // интеграл dx / τ(x) для квадратичного слоя (дискриминант отрицательный)
+    static const double a = 230, b = 0.006328, c = 0.000001172;
+    static const double d = std::sqrt(4 * a * c - b * b);
+    auto quadratic = [](double x) {
+        return 2 / d * std::atan((2 * c * x - b) / d);
+    };
+
+    static const double P9300 = 1000 * std::pow(normalTemperature(9300) / 288.9, n);
+    static const double P12000 = P9300 * std::exp(-(quadratic(2700) - quadratic(0)) / 29.27);
+
+    if (H <= 9300)
+        return 1000 * std::pow(normalTemperature(H) / 288.9, n);
+    if (H <= 12000)
+        return P9300 * std::exp(-(quadratic(H - 9300) - quadratic(0)) / 29.27);
 
+    return P12000 * std::exp(-(H - 12000) / (29.27 * normalTemperature(12000)));
+}
+
+double Analyzer::normalDensity(double H)
+{
+    return 0.34837 * normalPressure(H) / normalTemperature(H);
+}
+
+void Analyzer::fillTabDensity(const std::map<double, double>& DensityTable,std::vector<Zone>& zones)
+{
     for (auto& zone : zones)
     {
         double H = zone.Hi;
@@ -398,10 +613,10 @@ void Analyzer::fillTabDensity(const std::map<double, double>& DensityTable,std::
         // Находим первый элемент >= H
         auto upper = DensityTable.lower_bound(H);
 
-        // --- Случай 1: H выше всех табличных высот ---
+        // --- Случай 1: H выше всех табличных высот (или таблицы нет) ---
         if (upper == DensityTable.end())
         {
-            zone.Pitab = std::prev(upper)->second; // берём последнее значение
+            zone.Pitab = normalDensity(H);
             continue;
         }
 
@@ -470,50 +685,38 @@ void Analyzer::calculateDeltaH(std::vector<Zone>& Zones){
 
 // расчет давления в слое
 void Analyzer::calculatePn(std::vector<Zone>& zones, UserConstants globalParam){
+    integratePressure(zones, globalParam.P0);
+}
 
-    zones[0].Pn = globalParam.P0;
-    zones[1].Pn = globalParam.P0 * exp((-1/29.27*2)*(zones[1].height/zones[1].Tvrn));
-
-    for (size_t i = 2; i < zones.size(); ++i){
-
-        double a1 = zones[i].height - zones[i-1].height; // числитель первой дроби
-        double a2 = zones[i-1].height - zones[i-2].height; // числитель второй дроби
-
-        double x1 = a1/(zones[i].Tvrn + 273.15); // первая дробь
-        double x2 = a2/(zones[i-1].Tvrn + 273.15); // вторая дробь
+void Analyzer::integratePressure(std::vector<Zone>& zones, double P0, size_t from){
 
-        double e = (-1/58.54) * (x1 + x2); //внутри экпоненты
+    if (zones.empty())
+        return;
 
-        zones[i].Pn = zones[i-1].Pn * exp(e);
+    // R/g = 29.27 м/К, толщины слоев - по геопотенциальным высотам
+    if (from == 0) {
+        zones[0].Pn = P0;
+        from = 1;
     }
-}
 
-// расчет плотности в слое
-void Analyzer::calculatePi(std::vector<Zone>& zones){
+    double P = zones[from - 1].Pn;
+    for (size_t i = from; i < zones.size(); ++i){
 
-    for (size_t i = 0; i < zones.size(); ++i){
+        const double dH = zones[i].Hgeo - zones[i-1].Hgeo;
+        const double Tv = zones[i].Tvrn + 273.15;
 
-        if (zones[i].Hi > 1000){
-            continue;
-        }else{
-            zones[i].Pi = (zones[i].Pn * 0.4646)/(zones[i].Tvrn + 273.15);
-        }
+        P *= exp(-dH / (29.27 * Tv));
+        zones[i].Pn = P;
     }
 }
 
+void Analyzer::calculateGeopotential(std::vector<Zone>& zones, const GeopotentialProfile& profile){
 
-void Analyzer::calculatePPi(std::vector<Zone>& zones){
-    for (size_t i = 0; i < zones.size(); ++i){
-
-        if (zones[i].Hi > 1000){
-            continue;
-        }else{
-            double x = (zones[i].Pi - zones[i].Pitab)/(zones[i].Pitab);
-            zones[i].PPi = x * 100;
-        }
-    }
+    for (Zone& zone : zones)
+        zone.Hgeo = profile.geopotential(zone.height);
 }
 
+// расчет плотности в слое
 void Analyzer::calculatePPcpm(std::vector<Zone>& zones){
     zones[0].PPcpm = zones[0].PPi;
     for (size_t i = 1; i < zones.size(); ++i){
@@ -522,27 +725,40 @@ void Analyzer::calculatePPcpm(std::vector<Zone>& zones){
     }
 }
 
-// Расчет вертикальной устойчивости
+// Плотность и вертикальная устойчивость - один проход по зонам
 
+void Analyzer::calculateDensityAndStability(std::vector<Zone>& zones){
 
-void Analyzer::calculateTforR(std::vector<Zone>& zones){
+    const double Ga = 0.0098; // сухоадиабатический градиент, К/м
+    const double g = 9.8065;
 
-    double Ga = 0.0098;
-    double g = 9.8065;
+    for (size_t i = 0; i < zones.size(); ++i){
 
-    for (size_t i = 1; i < zones.size(); ++i){
+        Zone& zone = zones[i];
+        const double Tv = zone.Tvrn + 273.15;
 
-        double t0 = zones[i-1].Tvrn;
-        double t50 = zones[i].Tvrn;
+        // давление на средней высоте зоны - среднее геометрическое давлений на
+        // границах (точно для изотермического слоя); Pn в гПа, П в кг/м3
+        const double P = (i == 0) ? zone.Pn : std::sqrt(zones[i-1].Pn * zone.Pn);
+        zone.Pi = (P * 0.34837) / Tv;
+        zone.PPi = (zone.Pi - zone.Pitab) / zone.Pitab * 100;
 
-        zones[i].T = (t0 + t50 / 2) + 273.15;
+        if (i == 0){
+            zone.T = Tv;
+            zone.Ri = NAN;
+            continue;
+        }
 
-        double chis = (Ga - (t0 - t50))/50;
+        // Ri между серединами зон i-1 и i: расстояние - полусумма толщин
+        const Zone& below = zones[i-1];
+        const double dz = (below.dH + zone.dH) / 2;
 
-        double znam = std::pow((zones[i].vx - zones[i-1].vx)/50, 2) + std::pow((zones[i].vz - zones[i-1].vz)/50, 2);
+        zone.T = (below.Tvrn + zone.Tvrn) / 2 + 273.15;
 
-        zones[i].Ri = (g/zones[i].T) * (chis/znam);
+        const double dTheta = (zone.Tvrn - below.Tvrn) / dz + Ga;
+        const double shear = std::pow((zone.vx - below.vx) / dz, 2) + std::pow((zone.vz - below.vz) / dz, 2);
 
+        zone.Ri = (g / zone.T) * (dTheta / shear);
     }
 }
 
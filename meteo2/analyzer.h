@@ -5,16 +5,38 @@
 #include <map>
 
 #include "types.h"
+#include "zonegrid.h"
+#include "siteconfig.h"
+#include "radiationtable.h"
+#include "virtualcorrection.h"
+
+// Измерения температуры, сгруппированные по зонам, для быстрого пересчета
+// при смене констант терморезистора: Yt = QO/QT от констант не зависит.
+struct ZoneSamples {
+    std::vector<double> yt;       // Yt всех измерений подряд, зона за зоной (NaN - QT == 0)
+    std::vector<size_t> offset;   // измерения зоны i: [offset[i], offset[i+1])
+    std::vector<double> dtpMean;  // средняя радиационная поправка зоны
+    std::vector<double> uMean;    // средняя измеренная влажность зоны (NaN - нет)
+};
 
 class Analyzer
 {
 public:
-    void createZones(std::vector<Zone>& zones,const std::vector<Coordinate>& coordinates);
+    // зоны по сетке дописываются после уже добавленных (нулевой зоны из лога)
+    void createZones(std::vector<Zone>& zones,const std::vector<Coordinate>& coordinates,
+                     const ZoneGrid& grid = ZoneGrid::standard());
 
-    void createZones(std::vector<Zone>& Zones);
+    void createZones(std::vector<Zone>& Zones,const ZoneGrid& grid = ZoneGrid::extended());
 
     void calculateVk(std::vector<Zone>& zones);
 
+    // ветер зоны - наклон прямой МНК X(t), Z(t) по всем отсчетам слоя,
+    // с оценкой СКО; зоны, где отсчетов меньше трех, считаются по calculateVk
+    void calculateVkLsq(std::vector<Zone>& zones, const std::vector<Coordinate>& coordinates);
+
+    // геопотенциальные высоты границ зон по профилю места
+    void calculateGeopotential(std::vector<Zone>& zones, const GeopotentialProfile& profile);
+
     void calculateVi(const std::vector<Zone>& zones,std::vector<Mtd>& mtd);
 
     void calculateV(std::vector<Mtd>& mtd);
@@ -27,7 +49,15 @@ public:
     void calculateDHmts(std::vector<Mts>& mts);
 
     void calculateT(std::vector<TemperatureRecord>& records, UserConstants globalParam);
+
+    // радиационная поправка записей по таблице: высота - середина зоны записи
+    void calculateRadiation(std::vector<TemperatureRecord>& records, const std::vector<Zone>& zones,
+                            const RadiationTable& table, double sunElevation);
     void calculateTn(const std::vector<TemperatureRecord>& records,std::vector<Zone>& zones);
+
+    // группировка измерений по зонам и пересчет Tn без повторного разбора логов
+    void groupSamples(const std::vector<TemperatureRecord>& records, size_t zoneCount, ZoneSamples& samples);
+    void calculateTnFast(const ZoneSamples& samples, const UserConstants& globalParam, std::vector<Zone>& zones);
     void calculateMediumHeight(std::vector<Zone>& zones);
     //void calculateDTvir(std::unordered_map<double, double> Tvir, std::vector<TemperatureRecord>& records);
     void calculateTpni(std::vector<TemperatureRecord>& records);
@@ -36,6 +66,9 @@ public:
     //void calculateDTvir(const std::array<double, 51>& Tvir,std::vector<TemperatureRecord>& records);
     void addRadio(std::vector<TemperatureRecord>& records);
     void calculateDTvir(std::vector<Zone>& zones, UserConstants globalParam);
+    void calculateDTvir(std::vector<Zone>& zones, const VirtualCorrection& correction);
+    // наземная виртуальная температура (поправка calculateDTvir при H = 0)
+    double groundVirtualTemperature(UserConstants globalParam);
     void addVir(std::vector<Zone>& zones);
     void fillTabTemperature(const std::map<double, double>& temperatureTable,std::vector<Zone>& zones);
     void calculateTTi(std::vector<Zone>& zones);
@@ -144,23 +177,42 @@ public:
     }
 
     //давление и плотность
+
+    // нормальная артиллерийская атмосфера: виртуальная температура, К,
+    // давление, гПа, и плотность, кг/м3, на высоте H, м
+    static double normalTemperature(double H);
+    static double normalPressure(double H);
+    static double normalDensity(double H);
+
+    // табличная плотность по высоте Hi; выше таблицы - нормальная атмосфера
     void fillTabDensity(const std::map<double, double>& DensityTable,std::vector<Zone>& zones);
     void calculatePn(std::vector<Zone>& zones, UserConstants globalParam);
-    void calculatePi(std::vector<Zone>& zones);
-    void calculatePPi(std::vector<Zone>& zones);
-    void calculatePPcpm(std::vector<Zone>& zones);
 
-    //вертикальная устойчивость
+    // давление на верхних границах зон - барометрическая формула за один проход:
+    //   Pn_i = Pn_(i-1) * exp(-(H'_i - H'_(i-1)) / (29.27 * (Tvrn_i + 273.15))),
+    // H' - геопотенциальные высоты, сетка и верхняя граница любые.
+    // from > 0 - пересчет с зоны from, давление ниже (Pn_(from-1)) уже верное
+    void integratePressure(std::vector<Zone>& zones, double P0, size_t from = 0);
+    void calculatePPcpm(std::vector<Zone>& zones);
 
-    void calculateTforR(std::vector<Zone>& zones);
+    // плотность Pi, ее отклонение PPi и вертикальная устойчивость за один проход:
+    //   Ri = g / T * (dTv/dz + Ga) / ((dvx/dz)^2 + (dvz/dz)^2)
+    // между серединами соседних зон, dz = (dH_(i-1) + dH_i) / 2;
+    // у нулевой зоны Ri = NaN (нижнего соседа нет)
+    void calculateDensityAndStability(std::vector<Zone>& zones);
 
     double napr(double x, double z);
     void createBullutin(std::vector<Mtd>& mtd);
     void createBullutinMts(std::vector<Mts>& mts);
-    QString WindCode(int windDirection, int windSpeed);
 
-private:
-    const Coordinate* findClosest(double h,const std::vector<Coordinate>& coords);
+    // высота зондирования: верх последней зоны, до которой дошла траектория
+    // и для которой есть блок лога температуры; уровни бюллетеня выше нее
+    // значений не имеют (интерполяция дала бы значения верхней зоны).
+    // Пустые coordinates или records (сессия без лога) высоту не ограничивают.
+    static double soundingTop(const std::vector<Zone>& zones,
+                              const std::vector<Coordinate>& coordinates,
+                              const std::vector<TemperatureRecord>& records);
+    QString WindCode(int windDirection, int windSpeed);
 };
 
 #endif
@@ -0,0 +1,308 @@
+#include "batchrunner.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+#include <algorithm>
+
+#include "bulletinwriter.h"
+#include "fileparser.h"
+
+void BatchRunner::setExport(const QString& dir, const std::vector<ResultWriter::Format>& formats)
+{
+    m_exportDir = dir;
+    m_exportFormats = formats;
+}
+
+std::vector<BatchRunner::Result> BatchRunner::run(const QString& archiveDir)
+{
+    QStringList dirs;
+
+    QDirIterator it(archiveDir, QStringList() << SoundingFile, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        dirs << QFileInfo(it.next()).absolutePath();
+
+    // порядок обработки не зависит от файловой системы
+    std::sort(dirs.begin(), dirs.end());
+
+    std::vector<Result> results;
+    results.reserve(size_t(dirs.size()) + 1);
+
+    if (!m_exportDir.isEmpty())
+    {
+        Result exportResult;
+        exportResult.dir = m_exportDir;
+
+        m_export = std::make_unique<ResultExport>(m_exportDir, m_exportFormats);
+        if (!m_export->open(&exportResult.message))
+        {
+            m_export.reset();
+            results.push_back(exportResult);
+            return results;
+        }
+    }
+
+    m_archiveDir = archiveDir;
+
+    for (const QString& dir : dirs)
+        results.push_back(runSounding(dir));
+
+    m_archiveDir.clear();
+
+    if (m_export)
+    {
+        Result exportResult;
+        exportResult.dir = m_exportDir;
+        exportResult.ok = m_export->close(&exportResult.message);
+        if (exportResult.ok)
+            exportResult.message = "выгрузка результатов";
+
+        m_export.reset();
+        results.push_back(exportResult);
+    }
+
+    return results;
+}
+
+BatchRunner::Result BatchRunner::runSounding(const QString& dir)
+{
+    Result result;
+    result.dir = dir;
+
+    const QDir soundingDir(dir);
+    QSettings ini(soundingDir.filePath(SoundingFile), QSettings::IniFormat);
+
+    const QString siteId = ini.value("site").toString().trimmed();
+    const SiteProfilePtr profile = siteId.isEmpty() ? m_sites.defaultProfile() : m_sites.find(siteId);
+
+    if (!profile)
+    {
+        result.message = "нет профиля места " + siteId;
+        return result;
+    }
+
+    result.site = profile->id;
+
+    // срок нельзя брать из времени изменения файла: оно меняется при копировании
+    if (!ini.contains("time"))
+    {
+        result.message = "не задан срок зондирования (time)";
+        return result;
+    }
+
+    const QDateTime soundingTime = QDateTime::fromString(ini.value("time").toString(), Qt::ISODate);
+    if (!soundingTime.isValid())
+    {
+        result.message = "неверный срок зондирования (time): " + ini.value("time").toString();
+        return result;
+    }
+
+    PipelineInput input;
+    profile->applyTo(input);
+
+    input.windLogPath = soundingDir.filePath(ini.value("wind", "wind.csv").toString());
+    input.tempLogPath = soundingDir.filePath(ini.value("temperature", "temp.csv").toString());
+
+    // файл зонда: калибровка датчика, наземные значения и табличная температура
+    const QString probeFile = soundingDir.filePath(ini.value("probe", "surface_probe.csv").toString());
+    if (ini.contains("probe") || QFileInfo::exists(probeFile))
+    {
+        FileParser parser;
+        SurfaceProbe probe;
+        QString error;
+
+        if (!parser.loadSurfaceProbe(probeFile, probe, &error))
+        {
+            result.message = "файл зонда " + probeFile + ": " + error;
+            return result;
+        }
+
+        input.constants = probe.constants;
+        if (!probe.temperatureTable.empty())
+            input.temperatureTable = probe.temperatureTable;
+    }
+
+    // значения из sounding.ini заменяют значения профиля и зонда
+    // пустое значение - не задано; ошибка в числе не превращается в 0
+    const std::vector<std::pair<const char*, double*>> surfaceValues = {
+        {"T0", &input.constants.T0},
+        {"U0", &input.constants.U0},
+        {"P0", &input.constants.P0},
+    };
+
+    for (const auto& [name, value] : surfaceValues)
+    {
+        const QString text = ini.value(name).toString().trimmed();
+        if (text.isEmpty())
+            continue;
+
+        bool ok = false;
+        *value = text.toDouble(&ok);
+        if (!ok)
+        {
+            result.message = QString("неверное значение %1: %2").arg(name, text);
+            return result;
+        }
+    }
+
+    if (!(input.constants.P0 > 0))
+    {
+        result.message = "давление у земли P0 должно быть больше 0";
+        return result;
+    }
+
+    if (input.radiationTable)
+    {
+        bool ok = false;
+        input.sunElevation = ini.value("sunElevation").toDouble(&ok);
+        if (!ok)
+        {
+            result.message = "не задана высота солнца (sunElevation)";
+            return result;
+        }
+    }
+
+    input.validate = m_validate;
+
+    const Pipeline::Status status = m_pipeline.run(input);
+
+    if (status == Pipeline::WindLogError)
+    {
+        result.message = "не удалось прочитать лог ветра " + input.windLogPath;
+        if (m_pipeline.windDiagnostics().rejected() > 0)
+            result.message += QString(": первая строка отброшена (%1)")
+                                  .arg(ParseDiagnostics::reasonText(m_pipeline.windDiagnostics().issues().front().reason));
+        return result;
+    }
+
+    if (status == Pipeline::TempLogError)
+    {
+        result.message = "не удалось прочитать лог температуры " + input.tempLogPath;
+        return result;
+    }
+
+    if (status == Pipeline::TempZoneMismatch)
+    {
+        result.message = "блоки лога температуры не соответствуют сетке зон " + input.zoneGrid.toString();
+        return result;
+    }
+
+    BulletinWriter::Surface surface;
+    surface.time = soundingTime;
+    surface.pressure = input.constants.P0;
+    surface.virtualTemperature = VirtualCorrection(input.constants).groundTemperature();
+
+    const std::vector<BulletinWriter::Sounding> soundings = {
+        {profile->station, surface, &m_pipeline.mtd(), &m_pipeline.mts(),
+         Analyzer::soundingTop(m_pipeline.zones(), m_pipeline.coordinates(), m_pipeline.records())}
+    };
+
+    if (!BulletinWriter::saveFile(soundingDir.filePath("mtd.txt"),
+                                  BulletinWriter::writeBatch(soundings, BulletinCodec::Type::MeteoD))
+        || !BulletinWriter::saveFile(soundingDir.filePath("m11.txt"),
+                                     BulletinWriter::writeBatch(soundings, BulletinCodec::Type::Meteo11)))
+    {
+        result.message = "не удалось записать бюллетени";
+        return result;
+    }
+
+    result.ok = true;
+    result.message = m_pipeline.summary();
+
+    Reference reference;
+    if (m_export)
+        readReference(dir, ini, reference);
+
+    SoundingQuality quality;
+    if (m_validate)
+        quality = checkQuality(dir, reference, result);
+
+    if (m_export)
+        exportSounding(dir, reference, m_validate ? &quality : nullptr);
+
+    return result;
+}
+
+void BatchRunner::readReference(const QString& dir, const QSettings& ini, Reference& reference) const
+{
+    const QDir soundingDir(dir);
+
+    if (ini.contains("bulletinMtd"))
+    {
+        FileParser parser;
+        if (m_validate)
+            parser.setDiagnostics(&reference.mtdDiagnostics);
+
+        if (!parser.parseTxtFile(soundingDir.filePath(ini.value("bulletinMtd").toString()), reference.mtd))
+            reference.mtd.clear();
+    }
+
+    if (ini.contains("bulletinMts"))
+    {
+        FileParser parser;
+        if (m_validate)
+            parser.setDiagnostics(&reference.mtsDiagnostics);
+
+        if (!parser.parseMeteoAverage(soundingDir.filePath(ini.value("bulletinMts").toString()), reference.mts))
+            reference.mts.clear();
+    }
+}
+
+SoundingQuality BatchRunner::checkQuality(const QString& dir, const Reference& reference, Result& result) const
+{
+    const ParseDiagnostics& wind = m_pipeline.windDiagnostics();
+    const ParseDiagnostics& temp = m_pipeline.tempDiagnostics();
+
+    SoundingQuality quality;
+    quality.windLines = wind.lines();
+    quality.windRejected = wind.rejected();
+    quality.tempLines = temp.lines();
+    quality.tempRejected = temp.rejected();
+    quality.bulletinRejected = reference.mtdDiagnostics.rejected() + reference.mtsDiagnostics.rejected();
+    quality.bulletinMissing = reference.mtdDiagnostics.count(ParseDiagnostics::MissingGroup)
+                              + reference.mtsDiagnostics.count(ParseDiagnostics::MissingGroup);
+
+    const double lines = quality.windLines + quality.tempLines;
+    quality.accepted = (lines > 0) ? (wind.accepted() + temp.accepted()) / lines : NAN;
+
+    result.message += "; ветер: " + wind.summary() + "; температура: " + temp.summary();
+
+    // карантин переписывается при каждом расчете, чтобы не оставался старый
+    QByteArray quarantine;
+    for (const ParseDiagnostics* diagnostics : {&wind, &temp, &reference.mtdDiagnostics, &reference.mtsDiagnostics})
+        diagnostics->appendQuarantine(quarantine);
+
+    const QString quarantineFile = QDir(dir).filePath(QuarantineFile);
+    if (quarantine.isEmpty())
+    {
+        QFile::remove(quarantineFile);
+    }
+    else
+    {
+        QFile file(quarantineFile);
+        if (!file.open(QIODevice::WriteOnly) || file.write(quarantine) != quarantine.size())
+            result.message += "; не удалось записать " + quarantineFile;
+    }
+
+    return quality;
+}
+
+void BatchRunner::exportSounding(const QString& dir, const Reference& reference, const SoundingQuality* quality)
+{
+    const std::vector<MtdResidual> mtdResiduals = ResultExport::residuals(m_pipeline.mtd(), reference.mtd);
+    const std::vector<MtsResidual> mtsResiduals = ResultExport::residuals(m_pipeline.mts(), reference.mts);
+
+    // имя зондирования - путь от каталога архива
+    const QString key = m_archiveDir.isEmpty() ? QFileInfo(dir).fileName()
+                                               : QDir(m_archiveDir).relativeFilePath(dir);
+    const QByteArray keyBytes = key.toUtf8();
+
+    m_export->writeSounding(keyBytes, m_pipeline.zones(), m_pipeline.mtd(), m_pipeline.mts(),
+                            mtdResiduals, mtsResiduals);
+
+    if (quality)
+        m_export->writeQuality(keyBytes, *quality);
+}
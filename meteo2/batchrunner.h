@@ -0,0 +1,90 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QSettings>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "pipeline.h"
+#include "siteprofile.h"
+#include "resultwriter.h"
+
+// Пакетная обработка архива зондирований без окна.
+//
+// Каждый подкаталог архива, в котором есть sounding.ini, - одно
+// зондирование:
+//
+//   site=ekb                 ; id профиля места, пусто - профиль по умолчанию
+//   wind=wind.csv            ; лог ветра (путь относительно каталога)
+//   temperature=temp.csv     ; лог температуры
+//   probe=surface_probe.csv  ; файл зонда (если есть - константы и таблица из него)
+//   time=2024-05-01T06:00:00 ; срок зондирования (обязателен)
+//   sunElevation=30          ; высота солнца, град (нужна, если в профиле есть
+//                            ; таблица радиационных поправок)
+//   T0=, U0=, P0=            ; наземные значения, пусто - из зонда или профиля
+//   bulletinMtd=, bulletinMts= ; бюллетени метеокомплекса для отклонений (необязательно)
+//
+// Зондирования разных мест в одном архиве считаются каждое со своим
+// профилем. Бюллетени mtd.txt и m11.txt пишутся в каталог зондирования.
+// С setExport результаты всех зондирований (зоны, МТД, МТС и отклонения от
+// бюллетеней) дописываются в общие файлы каталога выгрузки за один проход.
+// С setValidate логи и бюллетени разбираются в проверяющем режиме:
+// отброшенные строки пишутся в quarantine.txt каталога зондирования, а
+// число принятых и отброшенных строк - в сообщение и таблицу quality.
+class BatchRunner
+{
+public:
+    static constexpr const char* SoundingFile = "sounding.ini";
+    static constexpr const char* QuarantineFile = "quarantine.txt";
+
+    struct Result {
+        QString dir;
+        QString site;
+        bool ok = false;
+        QString message;
+    };
+
+    explicit BatchRunner(const SiteRegistry& sites) : m_sites(sites) {}
+
+    // пустой cacheDir - без дискового кэша этапов
+    void setCacheDir(const QString& dir) { m_pipeline.setCacheDir(dir); }
+
+    // пустой dir - без выгрузки
+    void setExport(const QString& dir, const std::vector<ResultWriter::Format>& formats);
+
+    void setValidate(bool validate) { m_validate = validate; }
+
+    std::vector<Result> run(const QString& archiveDir);
+    Result runSounding(const QString& dir);
+
+private:
+    // бюллетени метеокомплекса для отклонений (bulletinMtd, bulletinMts)
+    struct Reference {
+        std::vector<Bull_mtd> mtd;
+        std::vector<Bull_mts> mts;
+        ParseDiagnostics mtdDiagnostics;
+        ParseDiagnostics mtsDiagnostics;
+    };
+
+    void readReference(const QString& dir, const QSettings& ini, Reference& reference) const;
+
+    // метрики разбора последнего расчета; отброшенные строки - в карантин
+    SoundingQuality checkQuality(const QString& dir, const Reference& reference, Result& result) const;
+
+    // дописывает результаты последнего расчета в выгрузку
+    void exportSounding(const QString& dir, const Reference& reference, const SoundingQuality* quality);
+
+    const SiteRegistry& m_sites;
+    Pipeline m_pipeline;
+
+    QString m_exportDir;
+    std::vector<ResultWriter::Format> m_exportFormats;
+    bool m_validate = false;
+
+    // открыта на время run()
+    std::unique_ptr<ResultExport> m_export;
+    QString m_archiveDir;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,514 @@
+#include "bulletinarchive.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+// код отклонения -> значение со знаком
+int decodeDeviation(int code, int base = 50)
+{
+    return (code > base) ? -(code - base) : code;
+}
+
+// столбцы пишутся целиком, в порядке байт машины
+template<typename T>
+void writeColumn(QDataStream& out, const std::vector<T>& column)
+{
+    out << quint64(column.size());
+    out.writeRawData(reinterpret_cast<const char*>(column.data()), int(column.size() * sizeof(T)));
+}
+
+template<typename T>
+bool readColumn(QDataStream& in, std::vector<T>& column)
+{
+    quint64 count{};
+    in >> count;
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    // защита от поврежденного счетчика
+    const QIODevice* device = in.device();
+    if (device && count * sizeof(T) > quint64(device->size()))
+        return false;
+
+    column.resize(size_t(count));
+
+    const int bytes = int(count * sizeof(T));
+    return in.readRawData(reinterpret_cast<char*>(column.data()), bytes) == bytes;
+}
+
+} // namespace
+
+quint64 BulletinArchive::bulletinKey(qint64 time, int station, BulletinCodec::Type type)
+{
+    return (quint64(time) << 20) | (quint64(station & 0x7FFFF) << 1) | quint64(type == BulletinCodec::Type::MeteoD);
+}
+
+bool BulletinArchive::pathMonth(const QString& path, int& year, int& month)
+{
+    // ГГГГ, разделитель (или без него), ММ, необязательно день
+    static const QRegularExpression re(
+        "(?<!\\d)((?:19|20)\\d\\d)[-_./\\\\]?(0[1-9]|1[0-2])(?:[-_.]?(?:0[1-9]|[12]\\d|3[01]))?(?!\\d)");
+
+    bool found = false;
+
+    QRegularExpressionMatchIterator it = re.globalMatch(QDir::fromNativeSeparators(path));
+    while (it.hasNext())
+    {
+        // ближайшее к имени файла вхождение
+        const QRegularExpressionMatch match = it.next();
+        year = match.captured(1).toInt();
+        month = match.captured(2).toInt();
+        found = true;
+    }
+
+    return found;
+}
+
+qint64 BulletinArchive::issueTime(const BulletinCodec::Header& header, int year, int month)
+{
+    if (header.hour > 23 || header.minute10 > 5)
+        return -1;
+
+    if (!QDate::isValid(year, month, header.day))
+        return -1;
+
+    const QDateTime time(QDate(year, month, header.day),
+                         QTime(header.hour, header.minute10 * 10),
+                         QTimeZone::UTC);
+
+    return time.toSecsSinceEpoch();
+}
+
+int BulletinArchive::ingestDirectory(const QString& dir)
+{
+    int added = 0;
+
+    QDirIterator it(dir, QStringList() << "*.txt", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        const QString fileName = it.next();
+        const QFileInfo info(fileName);
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+
+        // файл уже загружен и не менялся
+        auto known = m_files.find(info.absoluteFilePath());
+        if (known != m_files.end() && known->second == modified)
+            continue;
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            m_errors << fileName;
+            continue;
+        }
+
+        bool ok = false;
+        added += ingestData(file.readAll(), info.absoluteFilePath(), ok);
+        if (ok)
+            m_files[info.absoluteFilePath()] = modified;
+    }
+
+    rebuildIndex();
+    return added;
+}
+
+int BulletinArchive::ingestFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        m_errors << fileName;
+        return 0;
+    }
+
+    const QFileInfo info(fileName);
+
+    bool ok = false;
+    const int added = ingestData(file.readAll(), info.absoluteFilePath(), ok);
+    if (ok)
+        m_files[info.absoluteFilePath()] = info.lastModified().toMSecsSinceEpoch();
+
+    rebuildIndex();
+    return added;
+}
+
+int BulletinArchive::ingestData(const QByteArray& data, const QString& fileName, bool& ok)
+{
+    ok = false;
+
+    int year = 0;
+    int month = 0;
+    if (!pathMonth(fileName, year, month))
+    {
+        m_errors << QString("%1: в пути нет года и месяца").arg(fileName);
+        return 0;
+    }
+
+    std::string_view text(data.constData(), size_t(data.size()));
+
+    // сначала разбирается весь файл, чтобы при ошибке ничего не добавить
+    std::vector<std::pair<BulletinCodec::Bulletin, qint64>> decoded;
+    BulletinCodec::Bulletin bulletin;
+    int line = 0;
+
+    // в файле может быть несколько бюллетеней подряд
+    while (text.find_first_not_of(" \t\r\n") != std::string_view::npos)
+    {
+        const std::string_view before = text;
+
+        int errorLine = 0;
+        if (!BulletinCodec::decodeNext(text, bulletin, &errorLine))
+        {
+            m_errors << QString("%1:%2: ошибка разбора").arg(fileName).arg(line + errorLine);
+            return 0;
+        }
+
+        const int first = line + 1;
+        line += int(std::count(before.begin(), before.begin() + (before.size() - text.size()), '\n'));
+
+        const qint64 time = issueTime(bulletin.header, year, month);
+        if (time < 0)
+        {
+            m_errors << QString("%1:%2: неверный срок").arg(fileName).arg(first);
+            return 0;
+        }
+
+        decoded.emplace_back(bulletin, time);
+    }
+
+    ok = true;
+    int added = 0;
+
+    for (const auto& [b, time] : decoded)
+    {
+        const auto [it, inserted] = m_keys.try_emplace(bulletinKey(time, b.header.station, b.type),
+                                                       quint32(m_time.size()));
+        if (inserted)
+        {
+            append(b, time);
+            ++added;
+        }
+        else if (!sameContent(it->second, b))
+        {
+            // исправленный бюллетень за тот же срок
+            replace(it->second, b);
+        }
+    }
+
+    return added;
+}
+
+quint8 BulletinArchive::appendGroups(const BulletinCodec::Bulletin& bulletin)
+{
+    quint8 count = 0;
+    for (const auto& g : bulletin.groups)
+    {
+        if (g.missing)
+            continue;
+
+        m_level.push_back(quint8(g.level));
+        m_groupDensity.push_back(g.density < 0 ? NoValue : qint8(decodeDeviation(g.density)));
+        m_groupTemperature.push_back(qint8(decodeDeviation(g.temperature)));
+        m_groupDirection.push_back(quint8(g.direction));
+        m_groupSpeed.push_back(quint8(g.speed));
+        ++count;
+    }
+
+    return count;
+}
+
+void BulletinArchive::append(const BulletinCodec::Bulletin& bulletin, qint64 time)
+{
+    const BulletinCodec::Header& h = bulletin.header;
+
+    m_time.push_back(time);
+    m_station.push_back(quint16(h.station));
+    m_type.push_back(quint8(bulletin.type));
+    m_elevation.push_back(quint16(h.elevation));
+    m_pressure.push_back(qint16(decodeDeviation(h.pressure, 500)));
+    m_temperature.push_back(qint8(decodeDeviation(h.temperature)));
+    m_firstGroup.push_back(quint32(m_level.size()));
+    m_groupCount.push_back(appendGroups(bulletin));
+}
+
+void BulletinArchive::replace(quint32 row, const BulletinCodec::Bulletin& bulletin)
+{
+    const BulletinCodec::Header& h = bulletin.header;
+
+    m_elevation[row] = quint16(h.elevation);
+    m_pressure[row] = qint16(decodeDeviation(h.pressure, 500));
+    m_temperature[row] = qint8(decodeDeviation(h.temperature));
+    m_firstGroup[row] = quint32(m_level.size());
+    m_groupCount[row] = appendGroups(bulletin);
+}
+
+bool BulletinArchive::sameContent(quint32 row, const BulletinCodec::Bulletin& bulletin) const
+{
+    const BulletinCodec::Header& h = bulletin.header;
+
+    if (m_elevation[row] != quint16(h.elevation)
+        || m_pressure[row] != qint16(decodeDeviation(h.pressure, 500))
+        || m_temperature[row] != qint8(decodeDeviation(h.temperature)))
+        return false;
+
+    size_t g = m_firstGroup[row];
+    const size_t end = g + m_groupCount[row];
+
+    for (const auto& group : bulletin.groups)
+    {
+        if (group.missing)
+            continue;
+
+        if (g == end
+            || m_level[g] != quint8(group.level)
+            || m_groupDensity[g] != (group.density < 0 ? NoValue : qint8(decodeDeviation(group.density)))
+            || m_groupTemperature[g] != qint8(decodeDeviation(group.temperature))
+            || m_groupDirection[g] != quint8(group.direction)
+            || m_groupSpeed[g] != quint8(group.speed))
+            return false;
+
+        ++g;
+    }
+
+    return g == end;
+}
+
+void BulletinArchive::rebuildIndex()
+{
+    m_order.resize(m_time.size());
+    std::iota(m_order.begin(), m_order.end(), 0);
+
+    std::sort(m_order.begin(), m_order.end(), [this](quint32 a, quint32 b)
+    {
+        return (m_time[a] != m_time[b]) ? m_time[a] < m_time[b] : m_station[a] < m_station[b];
+    });
+}
+
+std::pair<size_t, size_t> BulletinArchive::range(const QDateTime& from, const QDateTime& to) const
+{
+    const qint64 t0 = from.toSecsSinceEpoch();
+    const qint64 t1 = to.toSecsSinceEpoch();
+
+    auto first = std::lower_bound(m_order.begin(), m_order.end(), t0,
+                                  [this](quint32 row, qint64 t) { return m_time[row] < t; });
+    auto last = std::upper_bound(first, m_order.end(), t1,
+                                 [this](qint64 t, quint32 row) { return t < m_time[row]; });
+
+    return {size_t(first - m_order.begin()), size_t(last - m_order.begin())};
+}
+
+std::vector<BulletinArchive::LevelSample> BulletinArchive::levelSeries(BulletinCodec::Type type, double height,
+                                                                       const QDateTime& from, const QDateTime& to,
+                                                                       int station) const
+{
+    std::vector<LevelSample> result;
+
+    // индексы уровней с этой высотой (у МЕТЕОД коды повторяются, высоты - нет)
+    size_t count = 0;
+    const BulletinCodec::LevelCode* table = BulletinCodec::levels(type, &count);
+
+    int level = -1;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (std::abs(table[i].height - height) < 0.5)
+            level = int(i);
+    }
+
+    if (level < 0)
+        return result;
+
+    const auto [first, last] = range(from, to);
+
+    for (size_t k = first; k < last; ++k)
+    {
+        const quint32 row = m_order[k];
+
+        if (m_type[row] != quint8(type) || (station >= 0 && m_station[row] != station))
+            continue;
+
+        // группы бюллетеня упорядочены по уровню
+        auto begin = m_level.begin() + m_firstGroup[row];
+        auto end = begin + m_groupCount[row];
+        auto it = std::lower_bound(begin, end, quint8(level));
+
+        if (it == end || *it != level)
+            continue;
+
+        const size_t g = size_t(it - m_level.begin());
+
+        LevelSample sample;
+        sample.time = m_time[row];
+        sample.station = m_station[row];
+        sample.temperature = m_groupTemperature[g];
+        sample.density = (m_groupDensity[g] == NoValue) ? NAN : double(m_groupDensity[g]);
+        sample.direction = m_groupDirection[g];
+        sample.speed = m_groupSpeed[g];
+
+        result.push_back(sample);
+    }
+
+    return result;
+}
+
+std::vector<BulletinArchive::Summary> BulletinArchive::bulletins(const QDateTime& from, const QDateTime& to,
+                                                                 int station) const
+{
+    std::vector<Summary> result;
+
+    const auto [first, last] = range(from, to);
+    result.reserve(last - first);
+
+    for (size_t k = first; k < last; ++k)
+    {
+        const quint32 row = m_order[k];
+        if (station >= 0 && m_station[row] != station)
+            continue;
+
+        Summary s;
+        s.time = m_time[row];
+        s.station = m_station[row];
+        s.type = BulletinCodec::Type(m_type[row]);
+        s.elevation = m_elevation[row];
+        s.pressure = m_pressure[row];
+        s.temperature = m_temperature[row];
+        s.levels = m_groupCount[row];
+
+        result.push_back(s);
+    }
+
+    return result;
+}
+
+void BulletinArchive::clear()
+{
+    *this = BulletinArchive();
+}
+
+bool BulletinArchive::save(const QString& fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(StreamVersion);
+
+    out << Magic << FormatVersion;
+
+    out << quint32(m_files.size());
+    for (const auto& [path, modified] : m_files)
+        out << path << modified;
+
+    writeColumn(out, m_time);
+    writeColumn(out, m_station);
+    writeColumn(out, m_type);
+    writeColumn(out, m_elevation);
+    writeColumn(out, m_pressure);
+    writeColumn(out, m_temperature);
+    writeColumn(out, m_firstGroup);
+    writeColumn(out, m_groupCount);
+
+    writeColumn(out, m_level);
+    writeColumn(out, m_groupDensity);
+    writeColumn(out, m_groupTemperature);
+    writeColumn(out, m_groupDirection);
+    writeColumn(out, m_groupSpeed);
+
+    if (out.status() != QDataStream::Ok)
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+bool BulletinArchive::load(const QString& fileName)
+{
+    clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(StreamVersion);
+
+    quint32 magic{};
+    quint32 version{};
+    quint32 files{};
+    in >> magic >> version >> files;
+
+    // в версии 1 срок брался из даты изменения файла - такой архив
+    // собирается заново
+    if (in.status() != QDataStream::Ok || magic != Magic || version != FormatVersion)
+        return false;
+
+    for (quint32 i = 0; i < files && in.status() == QDataStream::Ok; ++i)
+    {
+        QString path;
+        qint64 modified{};
+        in >> path >> modified;
+        m_files[path] = modified;
+    }
+
+    const bool ok = readColumn(in, m_time)
+                    && readColumn(in, m_station)
+                    && readColumn(in, m_type)
+                    && readColumn(in, m_elevation)
+                    && readColumn(in, m_pressure)
+                    && readColumn(in, m_temperature)
+                    && readColumn(in, m_firstGroup)
+                    && readColumn(in, m_groupCount)
+                    && readColumn(in, m_level)
+                    && readColumn(in, m_groupDensity)
+                    && readColumn(in, m_groupTemperature)
+                    && readColumn(in, m_groupDirection)
+                    && readColumn(in, m_groupSpeed);
+
+    // все столбцы одной таблицы одной длины
+    const size_t rows = m_time.size();
+    const size_t groups = m_level.size();
+
+    const bool consistent = m_station.size() == rows && m_type.size() == rows
+                            && m_elevation.size() == rows && m_pressure.size() == rows
+                            && m_temperature.size() == rows && m_firstGroup.size() == rows
+                            && m_groupCount.size() == rows
+                            && m_groupDensity.size() == groups && m_groupTemperature.size() == groups
+                            && m_groupDirection.size() == groups && m_groupSpeed.size() == groups;
+
+    if (!ok || !consistent)
+    {
+        clear();
+        return false;
+    }
+
+    for (size_t row = 0; row < rows; ++row)
+    {
+        if (m_firstGroup[row] + m_groupCount[row] > groups)
+        {
+            clear();
+            return false;
+        }
+
+        m_keys.emplace(bulletinKey(m_time[row], m_station[row], BulletinCodec::Type(m_type[row])), quint32(row));
+    }
+
+    rebuildIndex();
+    return true;
+}
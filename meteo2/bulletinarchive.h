@@ -0,0 +1,132 @@
+#ifndef BULLETINARCHIVE_H
+#define BULLETINARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "bulletincodec.h"
+
+// Архив принятых бюллетеней МЕТЕОД / МЕТЕО-11.
+//
+// Бюллетени разбираются один раз при загрузке каталога и хранятся
+// по столбцам: таблица бюллетеней (срок, станция, тип, заголовок) и
+// таблица групп уровней (уровень, ПП, ТТ, направление, скорость).
+// Отклонения хранятся уже со знаком. Индекс - номера бюллетеней,
+// упорядоченные по сроку и станции, поэтому выборка за период -
+// двоичный поиск и проход по непрерывному диапазону.
+//
+// Год и месяц в бюллетене не передаются: они берутся из пути файла
+// (последнее вхождение ГГГГ/ММ, ГГГГ-ММ, ГГГГММ или ГГГГММДД, например
+// archive/2024/05/mtd.txt). Файл без года и месяца в пути не загружается.
+//
+// Файл загружается целиком или не загружается: при ошибке разбора из него
+// ничего не добавляется, и он будет разобран снова при следующей загрузке.
+// Бюллетень с тем же сроком, станцией и типом, но другим содержимым
+// (исправленный) заменяет прежний.
+class BulletinArchive
+{
+public:
+    static constexpr quint32 Magic = 0x4D415243;  // "MARC"
+    static constexpr quint32 FormatVersion = 2;
+
+    // значение отсутствует (короткая группа без плотности)
+    static constexpr qint8 NoValue = -128;
+
+    struct LevelSample {
+        qint64 time{};        // срок, секунды UTC
+        int station{};
+        double temperature{}; // отклонение температуры
+        double density{};     // отклонение плотности, NaN - нет
+        double direction{};   // сотни делений угломера
+        double speed{};
+    };
+
+    struct Summary {
+        qint64 time{};
+        int station{};
+        BulletinCodec::Type type{};
+        int elevation{};
+        int pressure{};       // отклонение наземного давления
+        int temperature{};    // отклонение наземной температуры
+        int levels{};
+    };
+
+    // Загрузка всех *.txt каталога (с подкаталогами). Файлы, не изменившиеся
+    // с прошлой загрузки, пропускаются; повторные бюллетени не добавляются,
+    // исправленные - заменяют прежние. Возвращает число новых бюллетеней.
+    int ingestDirectory(const QString& dir);
+    int ingestFile(const QString& fileName);
+
+    // файлы, которые не удалось разобрать ("файл:строка: причина")
+    const QStringList& errors() const { return m_errors; }
+
+    // все значения уровня высотой height за [from, to]; station < 0 - все станции
+    std::vector<LevelSample> levelSeries(BulletinCodec::Type type, double height,
+                                         const QDateTime& from, const QDateTime& to,
+                                         int station = -1) const;
+
+    // бюллетени за период
+    std::vector<Summary> bulletins(const QDateTime& from, const QDateTime& to, int station = -1) const;
+
+    size_t bulletinCount() const { return m_time.size(); }
+    size_t groupCount() const { return m_level.size(); }
+    size_t fileCount() const { return m_files.size(); }
+
+    bool save(const QString& fileName) const;
+    bool load(const QString& fileName);
+
+    void clear();
+
+    // год и месяц из пути файла; false - в пути их нет
+    static bool pathMonth(const QString& path, int& year, int& month);
+
+    // срок бюллетеня по заголовку, году и месяцу; -1 - неверная дата
+    static qint64 issueTime(const BulletinCodec::Header& header, int year, int month);
+
+private:
+    // ok - файл разобран полностью (только тогда он считается загруженным)
+    int ingestData(const QByteArray& data, const QString& fileName, bool& ok);
+    void append(const BulletinCodec::Bulletin& bulletin, qint64 time);
+    // заголовок и группы строки row заменяются новыми
+    void replace(quint32 row, const BulletinCodec::Bulletin& bulletin);
+    bool sameContent(quint32 row, const BulletinCodec::Bulletin& bulletin) const;
+    quint8 appendGroups(const BulletinCodec::Bulletin& bulletin);
+    void rebuildIndex();
+
+    // диапазон индекса [first, last) по сроку
+    std::pair<size_t, size_t> range(const QDateTime& from, const QDateTime& to) const;
+
+    static quint64 bulletinKey(qint64 time, int station, BulletinCodec::Type type);
+
+    // бюллетени
+    std::vector<qint64>  m_time;
+    std::vector<quint16> m_station;
+    std::vector<quint8>  m_type;
+    std::vector<quint16> m_elevation;
+    std::vector<qint16>  m_pressure;
+    std::vector<qint8>   m_temperature;
+    std::vector<quint32> m_firstGroup;
+    std::vector<quint8>  m_groupCount;
+
+    // группы уровней (пропущенные "//////" не хранятся); группы замененных
+    // бюллетеней остаются в столбцах без ссылок на них
+    std::vector<quint8> m_level;
+    std::vector<qint8>  m_groupDensity;
+    std::vector<qint8>  m_groupTemperature;
+    std::vector<quint8> m_groupDirection;
+    std::vector<quint8> m_groupSpeed;
+
+    // номера бюллетеней по (срок, станция)
+    std::vector<quint32> m_order;
+
+    // ключ (срок, станция, тип) -> номер бюллетеня
+    std::unordered_map<quint64, quint32> m_keys;
+    std::map<QString, qint64> m_files;  // путь -> время изменения, мс
+    QStringList m_errors;
+};
+
+#endif // BULLETINARCHIVE_H
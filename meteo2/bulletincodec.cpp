@@ -0,0 +1,378 @@
+#include "bulletincodec.h"
+
+namespace BulletinCodec {
+
+namespace {
+
+constexpr std::string_view Prefix = "\xD0\x9C\xD0\x95\xD0\xA2\xD0\x95\xD0\x9E"; // "МЕТЕО"
+constexpr std::string_view LetterD = "\xD0\x94";                              // "Д"
+
+constexpr std::string_view Terminator11 = "1818";
+constexpr std::string_view TerminatorD  = "1616";
+
+constexpr int Pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+// очередная строка без \r и крайних пробелов; text сдвигается за нее
+std::string_view nextLine(std::string_view& text)
+{
+    const size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+        line.remove_suffix(1);
+    while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+        line.remove_prefix(1);
+
+    return line;
+}
+
+// последовательное чтение групп фиксированной ширины
+class Reader
+{
+public:
+    explicit Reader(std::string_view line) : m_line(line) {}
+
+    bool digits(int width, int& value)
+    {
+        if (m_line.size() < size_t(width))
+            return false;
+
+        int v = 0;
+        for (int i = 0; i < width; ++i)
+        {
+            const char c = m_line[i];
+            if (c < '0' || c > '9')
+                return false;
+            v = v * 10 + (c - '0');
+        }
+
+        value = v;
+        m_line.remove_prefix(width);
+        return true;
+    }
+
+    bool literal(std::string_view s)
+    {
+        if (m_line.substr(0, s.size()) != s)
+            return false;
+
+        m_line.remove_prefix(s.size());
+        return true;
+    }
+
+    bool literal(char c)
+    {
+        return literal(std::string_view(&c, 1));
+    }
+
+    // группа из width символов '/'
+    bool missing(int width)
+    {
+        if (m_line.size() < size_t(width))
+            return false;
+
+        for (int i = 0; i < width; ++i)
+        {
+            if (m_line[i] != '/')
+                return false;
+        }
+
+        m_line.remove_prefix(width);
+        return true;
+    }
+
+    void skipSpaces()
+    {
+        while (!m_line.empty() && m_line.front() == ' ')
+            m_line.remove_prefix(1);
+    }
+
+    bool peek(char c) const { return !m_line.empty() && m_line.front() == c; }
+    bool atEnd() const { return m_line.empty(); }
+
+private:
+    std::string_view m_line;
+};
+
+// ДДЧЧМ-ВВВВ-БББТТ-
+bool readDateGroups(Reader& r, Header& h)
+{
+    return r.digits(2, h.day) && r.digits(2, h.hour) && r.digits(1, h.minute10) && r.literal('-')
+           && r.digits(4, h.elevation) && r.literal('-')
+           && r.digits(3, h.pressure) && r.digits(2, h.temperature) && r.literal('-');
+}
+
+// ННПП-ТТННСС- или НН-ТТННСС-
+bool readLevel(std::string_view line, const LevelCode* table, size_t count,
+               size_t& next, Group& group)
+{
+    Reader r(line);
+
+    int code = 0;
+    if (!r.digits(2, code))
+        return false;
+
+    const bool shortForm = r.peek('-');
+
+    group.density = -1;
+    if (!shortForm && !r.digits(2, group.density))
+        return false;
+
+    if (!r.literal('-'))
+        return false;
+
+    group.missing = r.missing(6);
+    if (!group.missing)
+    {
+        if (!r.digits(2, group.temperature) || !r.digits(2, group.direction) || !r.digits(2, group.speed))
+            return false;
+    }
+    else
+    {
+        group.temperature = group.direction = group.speed = 0;
+    }
+
+    if (!r.literal('-') || !r.atEnd())
+        return false;
+
+    // уровень ищется после предыдущего: так различаются 70/700 и 70/7000
+    for (size_t i = next; i < count; ++i)
+    {
+        if (table[i].code == code && table[i].shortForm == shortForm)
+        {
+            group.level = int(i);
+            next = i + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// запись групп фиксированной ширины в буфер
+class Writer
+{
+public:
+    Writer(char* buffer, size_t capacity) : m_pos(buffer), m_begin(buffer), m_end(buffer + capacity) {}
+
+    void text(std::string_view s)
+    {
+        if (!m_ok || size_t(m_end - m_pos) < s.size())
+        {
+            m_ok = false;
+            return;
+        }
+
+        for (char c : s)
+            *m_pos++ = c;
+    }
+
+    void put(char c) { text(std::string_view(&c, 1)); }
+
+    void digits(int value, int width)
+    {
+        if (!m_ok || value < 0 || value >= Pow10[width] || m_end - m_pos < width)
+        {
+            m_ok = false;
+            return;
+        }
+
+        for (int i = width - 1; i >= 0; --i)
+        {
+            m_pos[i] = char('0' + value % 10);
+            value /= 10;
+        }
+        m_pos += width;
+    }
+
+    size_t size() const { return m_ok ? size_t(m_pos - m_begin) : 0; }
+
+private:
+    char* m_pos;
+    char* m_begin;
+    char* m_end;
+    bool m_ok = true;
+};
+
+void writeDateGroups(Writer& w, const Header& h)
+{
+    w.digits(h.day, 2);
+    w.digits(h.hour, 2);
+    w.digits(h.minute10, 1);
+    w.put('-');
+    w.digits(h.elevation, 4);
+    w.put('-');
+    w.digits(h.pressure, 3);
+    w.digits(h.temperature, 2);
+    w.put('-');
+}
+
+} // namespace
+
+const LevelCode* levels(Type type, size_t* count)
+{
+    if (type == Type::MeteoD)
+    {
+        *count = MtdLevels.size();
+        return MtdLevels.data();
+    }
+
+    *count = MtsLevels.size();
+    return MtsLevels.data();
+}
+
+bool decodeNext(std::string_view& text, Bulletin& out, int* errorLine)
+{
+    out.groups.clear();
+    out.header = Header{};
+
+    int lineNo = 0;
+    auto fail = [&]()
+    {
+        if (errorLine)
+            *errorLine = lineNo;
+        return false;
+    };
+
+    std::string_view line;
+    while (!text.empty() && line.empty())
+        line = nextLine(text);
+    ++lineNo;
+
+    // первая строка: МЕТЕО 11 ... или МЕТЕОD...
+    Reader r(line);
+    if (!r.literal(Prefix))
+        return fail();
+
+    r.skipSpaces();
+    Header& h = out.header;
+
+    if (r.literal('D') || r.literal(LetterD))
+    {
+        out.type = Type::MeteoD;
+
+        if (!r.digits(2, h.station) || !r.literal('-')
+            || !r.digits(8, h.position[0]) || !r.literal(' ')
+            || !r.digits(8, h.position[1]) || !r.literal('-') || !r.atEnd())
+            return fail();
+
+        Reader r2(nextLine(text));
+        ++lineNo;
+        if (!readDateGroups(r2, h) || !r2.atEnd())
+            return fail();
+    }
+    else if (r.literal("11"))
+    {
+        out.type = Type::Meteo11;
+
+        r.skipSpaces();
+        if (!r.digits(2, h.station) || !r.literal('-') || !readDateGroups(r, h) || !r.atEnd())
+            return fail();
+    }
+    else
+    {
+        return fail();
+    }
+
+    const std::string_view terminator = (out.type == Type::MeteoD) ? TerminatorD : Terminator11;
+
+    size_t count = 0;
+    const LevelCode* table = levels(out.type, &count);
+    size_t next = 0;
+
+    while (!text.empty())
+    {
+        line = nextLine(text);
+        ++lineNo;
+
+        if (line.empty())
+            continue;
+
+        if (line == terminator)
+            return true;
+
+        Group group;
+        if (!readLevel(line, table, count, next, group))
+            return fail();
+
+        out.groups.push_back(group);
+    }
+
+    // нет окончания
+    return fail();
+}
+
+size_t encode(const Bulletin& bulletin, char* buffer, size_t capacity)
+{
+    Writer w(buffer, capacity);
+    const Header& h = bulletin.header;
+
+    w.text(Prefix);
+
+    if (bulletin.type == Type::MeteoD)
+    {
+        w.put('D');
+        w.digits(h.station, 2);
+        w.put('-');
+        w.digits(h.position[0], 8);
+        w.put(' ');
+        w.digits(h.position[1], 8);
+        w.text("-\n");
+        writeDateGroups(w, h);
+        w.put('\n');
+    }
+    else
+    {
+        w.text(" 11 ");
+        w.digits(h.station, 2);
+        w.put('-');
+        writeDateGroups(w, h);
+        w.put('\n');
+    }
+
+    size_t count = 0;
+    const LevelCode* table = levels(bulletin.type, &count);
+
+    for (const Group& g : bulletin.groups)
+    {
+        if (g.level < 0 || size_t(g.level) >= count)
+            return 0;
+
+        const LevelCode& level = table[g.level];
+
+        w.digits(level.code, 2);
+        if (!level.shortForm)
+            w.digits(g.density, 2);
+        w.put('-');
+
+        if (g.missing)
+        {
+            w.text("//////");
+        }
+        else
+        {
+            w.digits(g.temperature, 2);
+            w.digits(g.direction, 2);
+            w.digits(g.speed, 2);
+        }
+        w.text("-\n");
+    }
+
+    w.text(bulletin.type == Type::MeteoD ? TerminatorD : Terminator11);
+    w.put('\n');
+
+    return w.size();
+}
+
+QByteArray encode(const Bulletin& bulletin)
+{
+    QByteArray data(int(MaxSize), Qt::Uninitialized);
+
+    const size_t size = encode(bulletin, data.data(), size_t(data.size()));
+    data.truncate(int(size));
+
+    return data;
+}
+
+} // namespace BulletinCodec
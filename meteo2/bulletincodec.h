@@ -0,0 +1,145 @@
+#ifndef BULLETINCODEC_H
+#define BULLETINCODEC_H
+
+#include <QByteArray>
+#include <array>
+#include <string_view>
+#include <vector>
+
+// Кодек бюллетеней "МЕТЕО-11" (метеосредний) и "МЕТЕОД" (метеодействительный).
+//
+// Раскладка групп (как в m11.txt / mtd.txt):
+//
+//   МЕТЕО 11 СС-ДДЧЧМ-ВВВВ-БББТТ-           МЕТЕОDСС-XXXXXXXX YYYYYYYY-
+//   ННПП-ТТННСС-                             ДДЧЧМ-ВВВВ-БББТТ-
+//   ...                                      ННПП-ТТННСС-
+//   НН-ТТННСС-     (высокие уровни)          ...
+//   1818                                     1616
+//
+// НН - код высоты, ПП - отклонение плотности, ТТ - температуры,
+// НН (в ТТННСС) - направление ветра в сотнях делений угломера, СС - скорость.
+// Пропущенная группа ТТННСС передается как "//////".
+//
+// Все значения хранятся в виде кодов, как они записаны в бюллетене
+// (коды больше 50 у отклонений означают отрицательные значения).
+// Декодер работает по байтам входного буфера без выделения памяти
+// на отдельные поля; кодер пишет в заранее выделенный буфер.
+namespace BulletinCodec {
+
+enum class Type {
+    Meteo11,  // метеосредний, окончание 1818
+    MeteoD    // метеодействительный, окончание 1616
+};
+
+// уровень бюллетеня: код высоты и высота в метрах
+struct LevelCode {
+    int code;
+    double height;
+    bool shortForm;  // группа НН-ТТННСС- без плотности
+};
+
+// уровни в порядке следования; коды 70 и 90 в МЕТЕОД встречаются дважды
+// (700/7000 и 900/9000) и различаются только положением
+constexpr std::array<LevelCode, 24> MtdLevels = {{
+    {4,  4,     false},
+    {25, 25,    false},
+    {75, 75,    false},
+    {15, 150,   false},
+    {30, 300,   false},
+    {50, 500,   false},
+    {70, 700,   false},
+    {90, 900,   false},
+    {11, 1100,  false},
+    {14, 1400,  false},
+    {18, 1800,  false},
+    {22, 2200,  false},
+    {27, 2700,  false},
+    {35, 3500,  false},
+    {45, 4500,  false},
+    {55, 5500,  false},
+    {70, 7000,  false},
+    {90, 9000,  false},
+    {11, 11000, true},
+    {13, 13000, true},
+    {16, 16000, true},
+    {20, 20000, true},
+    {24, 24000, true},
+    {28, 28000, true},
+}};
+
+constexpr std::array<LevelCode, 19> MtsLevels = {{
+    {2,  200,   false},
+    {4,  400,   false},
+    {8,  800,   false},
+    {12, 1200,  false},
+    {16, 1600,  false},
+    {20, 2000,  false},
+    {24, 2400,  false},
+    {30, 3000,  false},
+    {40, 4000,  false},
+    {50, 5000,  false},
+    {60, 6000,  false},
+    {80, 8000,  false},
+    {10, 10000, false},
+    {12, 12000, true},
+    {14, 14000, true},
+    {18, 18000, true},
+    {22, 22000, true},
+    {26, 26000, true},
+    {30, 30000, true},
+}};
+
+// заголовок: номер станции, срок, высота станции, наземные отклонения
+struct Header {
+    int station{};
+    int day{};
+    int hour{};
+    int minute10{};      // десятки минут
+    int elevation{};     // высота станции, м
+    int pressure{};      // код БББ
+    int temperature{};   // код ТТ
+
+    std::array<int, 2> position{};  // две группы по 8 цифр (только МЕТЕОД)
+};
+
+struct Group {
+    int level{};         // индекс в таблице уровней
+    int density{-1};     // код ПП, -1 для коротких групп
+    int temperature{};
+    int direction{};
+    int speed{};
+    bool missing{};      // "//////"
+};
+
+struct Bulletin {
+    Type type{Type::Meteo11};
+    Header header;
+    std::vector<Group> groups;
+};
+
+// таблица уровней для типа бюллетеня
+const LevelCode* levels(Type type, size_t* count);
+
+// Разбор одного бюллетеня с начала text; text сдвигается за окончание.
+// Пустые строки перед бюллетенем пропускаются. groups в out очищается
+// (выделенная память переиспользуется). При ошибке errorLine получает
+// номер строки внутри бюллетеня (с 1).
+bool decodeNext(std::string_view& text, Bulletin& out, int* errorLine = nullptr);
+
+inline bool decode(std::string_view text, Bulletin& out, int* errorLine = nullptr)
+{
+    return decodeNext(text, out, errorLine);
+}
+
+// наибольший размер бюллетеня в байтах
+constexpr size_t MaxSize = 64 + 2 * 40 + 32 * 16;
+
+// Запись в буфер; возвращает число записанных байт или 0,
+// если буфер мал или значение не помещается в свою группу.
+size_t encode(const Bulletin& bulletin, char* buffer, size_t capacity);
+
+QByteArray encode(const Bulletin& bulletin);
+
+} // namespace BulletinCodec
+
+#endif // BULLETINCODEC_H
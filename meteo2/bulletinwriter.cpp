@@ -0,0 +1,178 @@
+#include "bulletinwriter.h"
+
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// индекс значения с высотой h в векторе уровней или -1
+template<typename T>
+int findLevel(const std::vector<T>& levels, double h, double below)
+{
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        // наземный уровень: все, что ниже следующего табличного уровня
+        if (below > 0 ? levels[i].h < below : std::abs(levels[i].h - h) < 0.5)
+            return int(i);
+    }
+
+    return -1;
+}
+
+bool isValid(double value)
+{
+    return std::isfinite(value);
+}
+
+} // namespace
+
+int BulletinWriter::deviationCode(double value, int base)
+{
+    // в группу помещается |x| < base
+    const int x = std::min(qRound(std::abs(value)), base - 1);
+
+    return (value < 0 && x != 0) ? base + x : x;
+}
+
+void BulletinWriter::buildHeader(const Station& station, const Surface& surface, BulletinCodec::Header& header)
+{
+    header.station = station.number;
+    header.position = station.position;
+    header.elevation = station.elevation;
+
+    const QDateTime time = surface.time.isValid() ? surface.time : QDateTime::currentDateTime();
+
+    header.day = time.date().day();
+    header.hour = time.time().hour();
+    header.minute10 = time.time().minute() / 10;
+
+    header.pressure = deviationCode(surface.pressure * HpaToMmHg - NormalPressure, 500);
+    header.temperature = deviationCode(surface.virtualTemperature - NormalVirtualTemperature);
+}
+
+void BulletinWriter::buildMeteoD(const Station& station, const Surface& surface,
+                                 const std::vector<Mtd>& mtd, BulletinCodec::Bulletin& bulletin,
+                                 double top)
+{
+    using namespace BulletinCodec;
+
+    bulletin.type = Type::MeteoD;
+    bulletin.groups.clear();
+    buildHeader(station, surface, bulletin.header);
+
+    for (size_t i = 0; i < MtdLevels.size(); ++i)
+    {
+        const LevelCode& level = MtdLevels[i];
+
+        // первый уровень (код 04) - приземный, в mtd он идет первым
+        const int k = findLevel(mtd, level.height, i == 0 ? MtdLevels[1].height : 0.0);
+
+        Group group;
+        group.level = int(i);
+
+        if (k < 0 || mtd[k].h > top
+            || !isValid(mtd[k].TTi) || !isValid(mtd[k].v) || !isValid(mtd[k].av))
+        {
+            group.missing = true;
+        }
+        else
+        {
+            const Mtd& m = mtd[k];
+
+            group.density = level.shortForm ? -1 : deviationCode(isValid(m.PPi) ? m.PPi : 0.0);
+            group.temperature = deviationCode(m.TTi);
+            group.direction = qRound(m.av) % 60;
+            group.speed = std::clamp(qRound(m.v), 0, 99);
+        }
+
+        bulletin.groups.push_back(group);
+    }
+}
+
+void BulletinWriter::buildMeteo11(const Station& station, const Surface& surface,
+                                  const std::vector<Mts>& mts, BulletinCodec::Bulletin& bulletin,
+                                  double top)
+{
+    using namespace BulletinCodec;
+
+    bulletin.type = Type::Meteo11;
+    bulletin.groups.clear();
+    buildHeader(station, surface, bulletin.header);
+
+    for (size_t i = 0; i < MtsLevels.size(); ++i)
+    {
+        const LevelCode& level = MtsLevels[i];
+        const int k = findLevel(mts, level.height, 0.0);
+
+        Group group;
+        group.level = int(i);
+
+        if (k < 0 || mts[k].h > top
+            || !isValid(mts[k].TTcpm) || !isValid(mts[k].w) || !isValid(mts[k].aw))
+        {
+            group.missing = true;
+        }
+        else
+        {
+            const Mts& m = mts[k];
+
+            group.density = level.shortForm ? -1 : deviationCode(isValid(m.PPcpm) ? m.PPcpm : 0.0);
+            group.temperature = deviationCode(m.TTcpm);
+            group.direction = qRound(m.aw) % 60;
+            group.speed = std::clamp(qRound(m.w), 0, 99);
+        }
+
+        bulletin.groups.push_back(group);
+    }
+}
+
+QByteArray BulletinWriter::writeBatch(const std::vector<Sounding>& soundings, BulletinCodec::Type type)
+{
+    // бюллетень + пустая строка-разделитель
+    QByteArray data(int(soundings.size() * (BulletinCodec::MaxSize + 1)), Qt::Uninitialized);
+
+    BulletinCodec::Bulletin bulletin;
+    bulletin.groups.reserve(BulletinCodec::MtdLevels.size());
+
+    char* out = data.data();
+    size_t used = 0;
+
+    for (const auto& sounding : soundings)
+    {
+        if (type == BulletinCodec::Type::MeteoD)
+        {
+            if (!sounding.mtd)
+                continue;
+            buildMeteoD(sounding.station, sounding.surface, *sounding.mtd, bulletin, sounding.top);
+        }
+        else
+        {
+            if (!sounding.mts)
+                continue;
+            buildMeteo11(sounding.station, sounding.surface, *sounding.mts, bulletin, sounding.top);
+        }
+
+        const size_t n = BulletinCodec::encode(bulletin, out + used, size_t(data.size()) - used);
+        if (n == 0)
+            continue;
+
+        used += n;
+        out[used++] = '\n';
+    }
+
+    data.truncate(int(used));
+    return data;
+}
+
+bool BulletinWriter::saveFile(const QString& fileName, const QByteArray& data)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(data);
+
+    return file.commit();
+}
@@ -0,0 +1,72 @@
+#ifndef BULLETINWRITER_H
+#define BULLETINWRITER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "types.h"
+#include "bulletincodec.h"
+
+// Формирование бюллетеней "МЕТЕОД" и "МЕТЕО-11" по рассчитанным mtd/mts.
+//
+// Значения переводятся в коды групп: отклонения округляются до целых,
+// отрицательные передаются как 50 + |x| (давление у земли - 500 + |x|),
+// направление - в сотнях делений угломера. Уровни без данных и уровни
+// выше высоты зондирования передаются пропущенной группой "//////".
+class BulletinWriter
+{
+public:
+    // нормальные наземные значения для отклонений заголовка
+    static constexpr double NormalPressure = 750.0;          // мм рт. ст.
+    static constexpr double NormalVirtualTemperature = 15.9; // °C
+    static constexpr double HpaToMmHg = 0.750062;
+
+    struct Station {
+        int number = 1;
+        int elevation = 0;              // высота станции, м
+        std::array<int, 2> position{};  // группы координат МЕТЕОД
+    };
+
+    struct Surface {
+        QDateTime time;                 // срок зондирования
+        double pressure{};              // наземное давление, гПа
+        double virtualTemperature{};    // наземная виртуальная температура, °C
+    };
+
+    // одно зондирование для пакетной записи
+    struct Sounding {
+        Station station;
+        Surface surface;
+        const std::vector<Mtd>* mtd = nullptr;
+        const std::vector<Mts>* mts = nullptr;
+        // высота зондирования, м (Analyzer::soundingTop)
+        double top = INFINITY;
+    };
+
+    // top - высота зондирования: уровни выше нее пропускаются
+    static void buildMeteoD(const Station& station, const Surface& surface,
+                            const std::vector<Mtd>& mtd, BulletinCodec::Bulletin& bulletin,
+                            double top = INFINITY);
+
+    static void buildMeteo11(const Station& station, const Surface& surface,
+                             const std::vector<Mts>& mts, BulletinCodec::Bulletin& bulletin,
+                             double top = INFINITY);
+
+    // Пакетная запись: все бюллетени одного типа подряд через пустую строку,
+    // буфер выделяется один раз на весь пакет.
+    static QByteArray writeBatch(const std::vector<Sounding>& soundings, BulletinCodec::Type type);
+
+    static bool saveFile(const QString& fileName, const QByteArray& data);
+
+    // код отклонения: отрицательные значения - base + |x|
+    static int deviationCode(double value, int base = 50);
+
+private:
+    static void buildHeader(const Station& station, const Surface& surface, BulletinCodec::Header& header);
+};
+
+#endif // BULLETINWRITER_H
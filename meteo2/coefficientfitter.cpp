@@ -0,0 +1,235 @@
+#include "coefficientfitter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// штраф для наборов, при которых формула температуры не определена
+constexpr double Invalid = std::numeric_limits<double>::max() / 4;
+
+// как часто сообщать о ходе подбора
+constexpr int ProgressEvery = 50;
+
+} // namespace
+
+CoefficientFitter::CoefficientFitter(const std::vector<Zone>& zones,
+                                     const ZoneSamples& samples,
+                                     const std::vector<Bull_mtd>& bulletin)
+    : m_zones(zones)
+    , m_samples(samples)
+{
+    for (const auto& record : bulletin)
+    {
+        // неизвестные коды высот дают h = -1
+        if (record.h <= 0)
+            continue;
+
+        m_levels.emplace_back(record.h);
+        m_targets.push_back(decodeTemperature(record.TTi));
+    }
+}
+
+double CoefficientFitter::decodeTemperature(double code)
+{
+    return (code > 50) ? -(code - 50) : code;
+}
+
+CoefficientFitter::Point CoefficientFitter::toPoint(const UserConstants& c)
+{
+    return {c.A, c.B, c.C, c.R1, c.R2};
+}
+
+void CoefficientFitter::fromPoint(const Point& p, UserConstants& c)
+{
+    c.A  = p[0];
+    c.B  = p[1];
+    c.C  = p[2];
+    c.R1 = p[3];
+    c.R2 = p[4];
+}
+
+double CoefficientFitter::residual(const UserConstants& constants)
+{
+    ++m_evaluations;
+
+    if (constants.A <= 0 || m_targets.empty())
+        return Invalid;
+
+    m_analyzer.calculateTnFast(m_samples, constants, m_zones);
+    m_analyzer.calculateDTvir(m_zones, VirtualCorrection(constants));
+    m_analyzer.addVir(m_zones);
+    m_analyzer.calculateTTi(m_zones);
+    m_analyzer.interpolateTemperatureToBullutin(m_zones, m_levels);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < m_levels.size(); ++i)
+    {
+        double d = m_levels[i].TTi - m_targets[i];
+        sum += d * d;
+    }
+
+    return std::isfinite(sum) ? sum : Invalid;
+}
+
+CoefficientFitter::Result CoefficientFitter::fit(const UserConstants& start, const ProgressCallback& progress)
+{
+    Result result;
+    result.constants = start;
+
+    m_evaluations = 0;
+
+    // индексы подбираемых параметров
+    std::vector<int> dims;
+    for (int i = 0; i < ParamCount; ++i)
+    {
+        if (m_mask[i])
+            dims.push_back(i);
+    }
+
+    const size_t n = dims.size();
+    const double levels = std::max<size_t>(m_targets.size(), 1);
+
+    UserConstants work = start;
+
+    auto evaluate = [&](const Point& p)
+    {
+        fromPoint(p, work);
+        return residual(work);
+    };
+
+    // начальный симплекс: шаг 5% от значения параметра
+    std::vector<Point> simplex(n + 1, toPoint(start));
+    for (size_t k = 0; k < n; ++k)
+    {
+        double& v = simplex[k + 1][dims[k]];
+        v = (std::abs(v) > EPS) ? v * 1.05 : 0.05;
+    }
+
+    std::vector<double> f(n + 1);
+    for (size_t k = 0; k <= n; ++k)
+        f[k] = evaluate(simplex[k]);
+
+    result.startRms = std::sqrt(f[0] / levels);
+
+    std::vector<size_t> order(n + 1);
+    int iteration = 0;
+
+    for (; iteration < m_maxIterations && n > 0; ++iteration)
+    {
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return f[a] < f[b]; });
+
+        const size_t best = order.front();
+        const size_t worst = order.back();
+        const size_t second = order[n - 1];
+
+        if (progress && iteration % ProgressEvery == 0)
+        {
+            Progress p;
+            p.iteration = iteration;
+            p.evaluations = m_evaluations;
+            p.rms = std::sqrt(f[best] / levels);
+            p.best = start;
+            fromPoint(simplex[best], p.best);
+
+            if (!progress(p))
+            {
+                result.cancelled = true;
+                break;
+            }
+        }
+
+        // сходимость: разброс значений на симплексе
+        if (std::abs(f[worst] - f[best]) <= m_tolerance * (std::abs(f[best]) + m_tolerance))
+        {
+            result.converged = true;
+            break;
+        }
+
+        // центр тяжести без худшей вершины
+        Point centroid = simplex[best];
+        for (int d : dims)
+        {
+            double sum = 0.0;
+            for (size_t k = 0; k <= n; ++k)
+            {
+                if (k != worst)
+                    sum += simplex[k][d];
+            }
+            centroid[d] = sum / n;
+        }
+
+        auto along = [&](double t)
+        {
+            Point p = centroid;
+            for (int d : dims)
+                p[d] = centroid[d] + t * (simplex[worst][d] - centroid[d]);
+            return p;
+        };
+
+        // отражение
+        Point reflected = along(-1.0);
+        double fr = evaluate(reflected);
+
+        if (fr < f[best])
+        {
+            // растяжение
+            Point expanded = along(-2.0);
+            double fe = evaluate(expanded);
+
+            if (fe < fr)
+            {
+                simplex[worst] = expanded;
+                f[worst] = fe;
+            }
+            else
+            {
+                simplex[worst] = reflected;
+                f[worst] = fr;
+            }
+            continue;
+        }
+
+        if (fr < f[second])
+        {
+            simplex[worst] = reflected;
+            f[worst] = fr;
+            continue;
+        }
+
+        // сжатие (внешнее или внутреннее)
+        Point contracted = (fr < f[worst]) ? along(-0.5) : along(0.5);
+        double fc = evaluate(contracted);
+
+        if (fc < std::min(fr, f[worst]))
+        {
+            simplex[worst] = contracted;
+            f[worst] = fc;
+            continue;
+        }
+
+        // редукция к лучшей вершине
+        for (size_t k = 0; k <= n; ++k)
+        {
+            if (k == best)
+                continue;
+
+            for (int d : dims)
+                simplex[k][d] = simplex[best][d] + 0.5 * (simplex[k][d] - simplex[best][d]);
+
+            f[k] = evaluate(simplex[k]);
+        }
+    }
+
+    const size_t best = std::min_element(f.begin(), f.end()) - f.begin();
+
+    fromPoint(simplex[best], result.constants);
+    result.rms = std::sqrt(f[best] / levels);
+    result.iterations = iteration;
+    result.evaluations = m_evaluations;
+
+    return result;
+}
@@ -0,0 +1,83 @@
+#ifndef COEFFICIENTFITTER_H
+#define COEFFICIENTFITTER_H
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include "types.h"
+#include "analyzer.h"
+
+// Подбор констант терморезистора (A, B, C, R1, R2) методом Нелдера-Мида
+// по отклонениям TTi "метеодействительного" от загруженного бюллетеня.
+//
+// Каждая оценка - это calculateTnFast по сгруппированным измерениям зон
+// и короткая цепочка до TTi, без разбора логов и без давления/плотности.
+class CoefficientFitter
+{
+public:
+    static constexpr int ParamCount = 5; // A, B, C, R1, R2
+
+    struct Progress {
+        int iteration{};
+        int evaluations{};
+        double rms{};       // СКО TTi по уровням бюллетеня, градусы
+        UserConstants best{};
+    };
+
+    struct Result {
+        UserConstants constants{};
+        double rms{};
+        double startRms{};
+        int iterations{};
+        int evaluations{};
+        bool converged{};
+        bool cancelled{};
+    };
+
+    // progress вызывается периодически; вернуть false - прервать подбор
+    using ProgressCallback = std::function<bool(const Progress&)>;
+
+    // zones - результат полного расчета (Hi, Ttab уже заполнены),
+    // bulletin - уровни и TTi бюллетеня
+    CoefficientFitter(const std::vector<Zone>& zones,
+                      const ZoneSamples& samples,
+                      const std::vector<Bull_mtd>& bulletin);
+
+    // какие параметры подбирать (по умолчанию все)
+    void setFitMask(const std::array<bool, ParamCount>& mask) { m_mask = mask; }
+    void setMaxIterations(int iterations) { m_maxIterations = iterations; }
+    void setTolerance(double tolerance) { m_tolerance = tolerance; }
+
+    // число уровней бюллетеня, участвующих в сравнении
+    size_t targetCount() const { return m_targets.size(); }
+
+    // сумма квадратов отклонений TTi для набора констант
+    double residual(const UserConstants& constants);
+
+    Result fit(const UserConstants& start, const ProgressCallback& progress = {});
+
+    // значение TTi бюллетеня: коды больше 50 означают отрицательные отклонения
+    static double decodeTemperature(double code);
+
+private:
+    using Point = std::array<double, ParamCount>;
+
+    static Point toPoint(const UserConstants& constants);
+    static void fromPoint(const Point& point, UserConstants& constants);
+
+    Analyzer m_analyzer;
+
+    std::vector<Zone> m_zones;
+    ZoneSamples m_samples;
+
+    std::vector<Mtd> m_levels;      // уровни для интерполяции TTi
+    std::vector<double> m_targets;  // TTi бюллетеня на этих уровнях
+
+    std::array<bool, ParamCount> m_mask{true, true, true, true, true};
+    int m_maxIterations = 5000;
+    double m_tolerance = 1e-10;
+    int m_evaluations = 0;
+};
+
+#endif // COEFFICIENTFITTER_H
@@ -155,6 +155,24 @@ QString DisplayManager::HtmlMtdV(const CellInfo& cell, const Zone& currentZone,
                 .arg(currentZone.height)
                 .arg(currentZone.y);
 
+    // ветер по МНК: показываем число отсчетов и СКО составляющих
+    if (currentZone.nSamples > 0)
+    {
+        if (std::isfinite(currentZone.vxErr))
+        {
+            html += QString("<p>Составляющие найдены по МНК по <b>%1</b> отсчетам зоны: "
+                            "СКО Vxk <b>%2</b> м/с, СКО Vzk <b>%3</b> м/с</p>")
+                        .arg(currentZone.nSamples)
+                        .arg(currentZone.vxErr, 0, 'f', 3)
+                        .arg(currentZone.vzErr, 0, 'f', 3);
+        }
+        else
+        {
+            html += QString("<p>В зоне %1 отсчетов - мало для МНК, составляющие найдены по двум точкам</p>")
+                        .arg(currentZone.nSamples);
+        }
+    }
+
     html += R"(
 <p>
 Искомые значения Vxi, Vzi для высот бюллетеня рассчитываются путем линейной интерполяции
@@ -447,6 +465,13 @@ QString DisplayManager::HtmlTTi(const CellInfo& cell,
                 .arg(currentZone.dTvir)
                 .arg(currentZone.Hi);
 
+    // при измеренной влажности поправка считается по ней, а не по U0
+    if (!std::isnan(currentZone.Un))
+        html += QString(
+                    "<p>Поправка рассчитана по измеренной влажности зоны "
+                    "U = <span class='value'>%1</span> %</p>")
+                    .arg(currentZone.Un, 0, 'f', 1);
+
     html += R"(
 
 <p class="block">
@@ -775,3 +800,58 @@ QString DisplayManager::HtmlPPcpmMts(const CellInfo& cell, const std::vector<Zon
 
     return html;
 }
+
+QString DisplayManager::HtmlArchiveTTi(const BulletinArchive& archive, const std::vector<Mtd>& mtd,
+                                       const QDateTime& from, const QDateTime& to){
+
+    QString html;
+
+    html += "<h2>Архив бюллетеней</h2>";
+    html += QString("<p>Файлов: <b>%1</b>, бюллетеней: <b>%2</b></p>")
+                .arg(archive.fileCount())
+                .arg(archive.bulletinCount());
+    html += QString("<p>Период: %1 - %2</p>")
+                .arg(from.toString("dd.MM.yyyy"), to.toString("dd.MM.yyyy"));
+
+    html += "<table border='1' cellpadding='4'>";
+    html += "<tr><th>h, м</th><th>TTi расчет</th><th>бюллетеней</th>"
+            "<th>TTi среднее</th><th>TTi мин</th><th>TTi макс</th></tr>";
+
+    for (const auto& m : mtd)
+    {
+        const auto series = archive.levelSeries(BulletinCodec::Type::MeteoD, m.h, from, to);
+        if (series.empty())
+            continue;
+
+        double sum = 0.0;
+        double minT = series.front().temperature;
+        double maxT = series.front().temperature;
+
+        for (const auto& s : series)
+        {
+            sum += s.temperature;
+            minT = std::min(minT, s.temperature);
+            maxT = std::max(maxT, s.temperature);
+        }
+
+        html += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td></tr>")
+                    .arg(m.h)
+                    .arg(m.TTi, 0, 'f', 1)
+                    .arg(series.size())
+                    .arg(sum / series.size(), 0, 'f', 1)
+                    .arg(minT)
+                    .arg(maxT);
+    }
+
+    html += "</table>";
+
+    if (!archive.errors().isEmpty())
+    {
+        html += "<p>Не разобраны:</p><ul>";
+        for (const QString& error : archive.errors())
+            html += "<li>" + error.toHtmlEscaped() + "</li>";
+        html += "</ul>";
+    }
+
+    return html;
+}
@@ -2,6 +2,7 @@
 #define DISPLAYMANAGER_H
 
 #include "types.h"
+#include "bulletinarchive.h"
 #include <QString>
 
 class DisplayManager
@@ -38,6 +39,10 @@ public:
 
     QString HtmlPPcpmMtd(const CellInfo& cell, const std::vector<Zone>& zones, const std::vector<Mtd>& mtd);
     QString HtmlPPcpmMts(const CellInfo& cell, const std::vector<Zone>& zones, const std::vector<Mts>& mts);
+
+    // сравнение рассчитанного TTi с архивом бюллетеней МЕТЕОД за период
+    QString HtmlArchiveTTi(const BulletinArchive& archive, const std::vector<Mtd>& mtd,
+                           const QDateTime& from, const QDateTime& to);
 };
 
 #endif // DISPLAYMANAGER_H
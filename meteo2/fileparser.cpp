@@ -4,326 +4,277 @@
 #include <QMessageBox>
 #include <QtMath>
 #include "types.h"
+#include "bulletincodec.h"
 #include <QRegularExpression>
 #include <QDebug>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
 
-// Глобальные статические переменные для отслеживания использования кодов высот
-static bool used_12 = false;
-static bool used_14 = false;
-static bool used_18 = false;
-static bool used_22 = false;
-static bool used_26 = false;
-static bool used_30 = false;
+#include <algorithm>
 
-double convertHeight(int h_code)
+namespace {
+
+// строка бюллетеня с ошибкой - в карантин; errorLine считается
+// от начала бюллетеня, пустые строки перед ним кодек пропускает
+void rejectBulletinLine(const QByteArray& data, int errorLine, ParseDiagnostics& diagnostics)
 {
-    static bool first70 = true;
-    static bool first90 = true;
+    const QList<QByteArray> lines = data.split('\n');
 
-    if (h_code == 70)
-    {
-        if (first70)
-        {
-            first70 = false;
-            return 700;
-        }
-        else
-        {
-            return 7000;
-        }
-    }
+    int line = 0;
+    while (line < lines.size() && lines[line].trimmed().isEmpty())
+        ++line;
+    line += std::max(errorLine, 1);
 
-    if (h_code == 90)
-    {
-        if (first90)
-        {
-            first90 = false;
-            return 900;
-        }
-        else
-        {
-            return 9000;
-        }
-    }
+    const QString text = (line <= lines.size()) ? QString::fromUtf8(lines[line - 1].trimmed()) : QString();
+    diagnostics.reject(quint32(line), ParseDiagnostics::BadBulletin, 0, text);
+}
 
-    static const std::unordered_map<int, double> heightMap =
-        {
-            {4,   4},
-            {25,  25},
-            {75,  75},
+// чтение бюллетеня из файла через кодек
+bool decodeBulletinFile(const QString& fileName, BulletinCodec::Type type, BulletinCodec::Bulletin& bulletin,
+                        ParseDiagnostics* diagnostics)
+{
+    QFile file(fileName);
 
-            {15,  150},
-            {30,  300},
-            {50,  500},
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
 
-            {11, 1100},
-            {14, 1400},
-            {18, 1800},
+    const QByteArray data = file.readAll();
+    file.close();
 
-            {22, 2200},
-            {27, 2700},
+    int errorLine = 0;
+    if (!BulletinCodec::decode(std::string_view(data.constData(), size_t(data.size())), bulletin, &errorLine))
+    {
+        qDebug() << "Ошибка разбора бюллетеня" << fileName << "строка" << errorLine;
+        if (diagnostics)
+            rejectBulletinLine(data, errorLine, *diagnostics);
+        return false;
+    }
 
-            {35, 3500},
-            {45, 4500},
-            {55, 5500}
-        };
+    if (bulletin.type != type)
+    {
+        qDebug() << "Неверный тип бюллетеня:" << fileName;
+        if (diagnostics)
+            rejectBulletinLine(data, 1, *diagnostics);
+        return false;
+    }
 
-    auto it = heightMap.find(h_code);
+    if (diagnostics)
+    {
+        // строка заголовка (у МЕТЕОД - две) и строки групп
+        diagnostics->setLineCount(quint32((type == BulletinCodec::Type::MeteoD ? 2 : 1) + bulletin.groups.size()));
+
+        for (const auto& group : bulletin.groups)
+        {
+            if (group.missing)
+                diagnostics->note(0, ParseDiagnostics::MissingGroup, 0);
+        }
+    }
 
-    if (it != heightMap.end())
-        return it->second;
+    return true;
+}
 
-    return -1;
+// пределы столбцов лога ветра: дальность, азимут и угол места
+// (деления угломера), время; NaN и бесконечности не проходят сравнения
+int radarFieldOutOfRange(const double* v)
+{
+    if (!(v[0] >= 0))
+        return 1;
+    if (!(v[1] >= 0 && v[1] <= 6000))
+        return 2;
+    if (!(v[2] >= -1500 && v[2] <= 1500))
+        return 3;
+    if (!(v[3] >= 0))
+        return 4;
+
+    return 0;
 }
 
+} // namespace
 
 bool FileParser::parseTxtFile(const QString& fileName,
                               std::vector<Bull_mtd>& records)
 {
-    QFile file(fileName);
+    beginDiagnostics(fileName);
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    BulletinCodec::Bulletin bulletin;
+    if (!decodeBulletinFile(fileName, BulletinCodec::Type::MeteoD, bulletin, m_diagnostics))
         return false;
 
-    QTextStream in(&file);
-
-    int lineIndex = 0;
+    records.reserve(records.size() + bulletin.groups.size());
 
-    while (!in.atEnd())
+    for (const auto& group : bulletin.groups)
     {
-        QString line = in.readLine().trimmed();
-        lineIndex++;
-
-        // пропускаем первые две строки
-        if (lineIndex <= 2)
-            continue;
-
-        if (line.isEmpty())
-            continue;
-
-        if (line.length() < 11)
-            continue;
-
-        if (line.contains("//////"))
+        // пропущенные группы "//////" не переносим
+        if (group.missing)
             continue;
 
         Bull_mtd record;
 
-        int h_code = line.mid(0,2).toInt();
-
-        record.h   = convertHeight(h_code);
-
-        record.PPi = line.mid(2,2).toDouble();
-        record.TTi = line.mid(5,2).toDouble();
-        record.av  = line.mid(7,2).toDouble();
-        record.v   = line.mid(9,2).toDouble();
+        record.h   = BulletinCodec::MtdLevels[group.level].height;
+        record.PPi = (group.density < 0) ? NAN : double(group.density);
+        record.TTi = group.temperature;
+        record.av  = group.direction;
+        record.v   = group.speed;
 
         records.push_back(record);
     }
 
-    file.close();
     return true;
 }
 
-double convertHeightMts(int h_code, bool isFourDigitFormat)
-{
-    // Для 4-значного формата (HHPP) - это всегда высоты ДО 10000м
-    if (isFourDigitFormat)
-    {
-        static const std::unordered_map<int, double> heightMapFourDigit =
-            {
-                {2,   200},
-                {4,   400},
-                {8,   800},
-                {12, 1200},
-                {14, 1400},
-                {16, 1600},
-                {18, 1800},
-                {20, 2000},
-                {22, 2200},
-                {24, 2400},
-                {26, 2600},
-                {30, 3000},
-                {40, 4000},
-                {50, 5000},
-                {60, 6000},
-                {80, 8000},
-                {10, 10000}
-            };
-
-        auto it = heightMapFourDigit.find(h_code);
-        if (it != heightMapFourDigit.end())
-            return it->second;
-    }
-    else // Для 2-значного формата (HH) - это высоты ОТ 10000м и выше
-    {
-        static const std::unordered_map<int, double> heightMapTwoDigit =
-            {
-                {12, 12000},
-                {14, 14000},
-                {18, 18000},
-                {22, 22000},
-                {26, 26000},
-                {30, 30000}
-            };
-
-        auto it = heightMapTwoDigit.find(h_code);
-        if (it != heightMapTwoDigit.end())
-            return it->second;
-    }
-
-    qDebug() << "Unknown height code:" << h_code << "format:" << (isFourDigitFormat ? "4-digit" : "2-digit");
-    return -1;
-}
-
-// Функция для сброса флагов (добавьте её объявление в fileparser.h)
-void resetHeightMtsFlags()
-{
-    used_12 = false;
-    used_14 = false;
-    used_18 = false;
-    used_22 = false;
-    used_26 = false;
-    used_30 = false;
-}
-
 bool FileParser::parseMeteoAverage(const QString& fileName,
                                    std::vector<Bull_mts>& records)
 {
-    QFile file(fileName);
+    beginDiagnostics(fileName);
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    BulletinCodec::Bulletin bulletin;
+    if (!decodeBulletinFile(fileName, BulletinCodec::Type::Meteo11, bulletin, m_diagnostics))
         return false;
 
-    QTextStream in(&file);
-    bool isFirstLine = true;
+    records.reserve(records.size() + bulletin.groups.size());
 
-    while (!in.atEnd())
+    for (const auto& group : bulletin.groups)
     {
-        QString line = in.readLine().trimmed();
-
-        if (line.isEmpty())
+        if (group.missing)
             continue;
 
-        // Пропускаем первую строку с "МЕТЕО ..."
-        if (isFirstLine)
-        {
-            isFirstLine = false;
-            continue;
-        }
+        Bull_mts record;
 
-        // Встретили "1818" - конец бюллетеня
-        if (line == "1818")
-            break;
+        record.h     = BulletinCodec::MtsLevels[group.level].height;
+        record.PPcpm = (group.density < 0) ? NAN : double(group.density);
+        record.TTcpm = group.temperature;
+        record.aw    = group.direction;
+        record.w     = group.speed;
 
-        Bull_mts record;
+        records.push_back(record);
+    }
 
-        // Формат строки: "0201-555408-" или "12-193309-"
-        int dashPos = line.indexOf('-');
-        if (dashPos == -1)
-            continue;
+    qDebug() << "Total records parsed:" << records.size();
+    return true;
+}
 
-        QString codePart = line.left(dashPos);      // часть до первого дефиса
-        QString dataPart = line.mid(dashPos + 1);   // часть после первого дефиса
+bool FileParser::parseCSV(const QString& fileName,std::vector<Coordinate>& coordinates,Zone& firstZone,Mtd& firstMtd){
+    RadarSamples samples;
 
-        // Убираем последний дефис в конце строки, если есть
-        if (dataPart.endsWith('-'))
-            dataPart.chop(1);
+    if (!parseRadarCSV(fileName, samples, firstZone, firstMtd))
+        return false;
 
-        // Парсим данные: TT DD VV (всегда 6 символов)
-        if (dataPart.length() >= 6)
-        {
-            record.TTcpm = dataPart.mid(0, 2).toDouble();   // температура
-            record.aw    = dataPart.mid(2, 2).toDouble();   // направление ветра
-            record.w     = dataPart.mid(4, 2).toDouble();   // скорость ветра
-        }
-        else
-        {
-            continue;
-        }
+    computeCoordinates(samples, coordinates);
+    return true;
+}
 
-        // Определяем формат по длине codePart
-        if (codePart.length() == 4)
-        {
-            // Формат HHPP - высота (2 цифры) + давление (2 цифры)
-            int h_code = codePart.mid(0, 2).toInt();
-            record.h = convertHeightMts(h_code, true);  // true = 4-значный формат
-            record.PPcpm = codePart.mid(2, 2).toDouble();
-
-            qDebug() << "4-char format:" << codePart
-                     << "h_code=" << h_code
-                     << "height=" << record.h
-                     << "pressure=" << record.PPcpm;
-        }
-        else if (codePart.length() == 2)
-        {
-            // Формат HH - только высота (высоты от 10000м и выше)
-            int h_code = codePart.toInt();
-            record.h = convertHeightMts(h_code, false);  // false = 2-значный формат
-            record.PPcpm = NAN;
-
-            qDebug() << "2-char format:" << codePart
-                     << "h_code=" << h_code
-                     << "height=" << record.h;
-        }
-        else
+void FileParser::beginDiagnostics(const QString& fileName)
+{
+    if (!m_diagnostics)
+        return;
+
+    m_diagnostics->clear();
+    m_diagnostics->setFileName(fileName);
+}
+
+bool FileParser::parseFields(const QStringList& values,int count,double* fields,
+                             quint32 lineNumber,const QString& line){
+    if (values.size() < count)
+    {
+        m_diagnostics->reject(lineNumber, ParseDiagnostics::TooFewFields, 0, line);
+        return false;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        bool ok = false;
+        fields[i] = values[i].toDouble(&ok);
+        if (!ok)
         {
-            qDebug() << "Unknown format:" << codePart << "length=" << codePart.length();
-            continue;
+            m_diagnostics->reject(lineNumber, ParseDiagnostics::BadNumber, i + 1, line);
+            return false;
         }
-
-        records.push_back(record);
     }
 
-    file.close();
-    qDebug() << "Total records parsed:" << records.size();
     return true;
 }
 
-bool FileParser::parseCSV(const QString& fileName,std::vector<Coordinate>& coordinates,Zone& firstZone,Mtd& firstMtd){
+bool FileParser::parseRadarCSV(const QString& fileName,RadarSamples& samples,Zone& firstZone,Mtd& firstMtd){
     QFile file(fileName);
 
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
         return false;
 
+    beginDiagnostics(fileName);
+
     QTextStream in(&file);
 
     bool isFirstLine = true;
+    quint32 lineNumber = 0;
+    quint32 dataLines = 0;
 
     while (!in.atEnd())
     {
         QString line = in.readLine().trimmed();
+        ++lineNumber;
         if (line.isEmpty())
             continue;
 
+        ++dataLines;
         QStringList values = line.split(',');
 
         if (isFirstLine)
         {
-            parseFirstLine(values, firstZone, firstMtd);
+            // без первой строки нет нулевой зоны: в проверяющем режиме
+            // такой лог не принимается
+            if (!parseFirstLine(values, firstZone, firstMtd, lineNumber, line))
+            {
+                m_diagnostics->setLineCount(dataLines);
+                return false;
+            }
             isFirstLine = false;
         }
         else
         {
-            parseDataLine(values, coordinates);
+            parseDataLine(values, samples, lineNumber, line);
         }
     }
 
     file.close();
+
+    if (m_diagnostics)
+        m_diagnostics->setLineCount(dataLines);
+
     return true;
 }
 
-void FileParser::parseFirstLine(const QStringList& values,Zone& firstZone,Mtd& firstMtd){
+bool FileParser::parseFirstLine(const QStringList& values,Zone& firstZone,Mtd& firstMtd,
+                                quint32 lineNumber,const QString& line){
 
-    if (values.size() < 6)
-        return;
+    double v[6]{};
 
-    double dglob = values[0].toDouble(); //дальность
-    double aglob = values[1].toDouble(); //азимут
-    double eglob = values[2].toDouble(); //угол места
-    double tglob = values[3].toDouble(); //время
-    double avi   = values[4].toDouble();
-    double vi    = values[5].toDouble();
+    if (m_diagnostics)
+    {
+        if (!parseFields(values, 6, v, lineNumber, line))
+            return false;
+
+        if (const int column = radarFieldOutOfRange(v))
+        {
+            m_diagnostics->reject(lineNumber, ParseDiagnostics::OutOfRange, column, line);
+            return false;
+        }
+    }
+    else
+    {
+        if (values.size() < 6)
+            return true;
+
+        for (int i = 0; i < 6; ++i)
+            v[i] = values[i].toDouble();
+    }
+
+    double dglob = v[0]; //дальность
+    double aglob = v[1]; //азимут
+    double eglob = v[2]; //угол места
+    double tglob = v[3]; //время
+    double avi   = v[4];
+    double vi    = v[5];
 
     firstZone.x = dglob * cos(eglob * KDU) * cos(aglob * KDU);
     firstZone.z = dglob * cos(eglob * KDU) * sin(aglob * KDU);
@@ -342,9 +293,33 @@ void FileParser::parseFirstLine(const QStringList& values,Zone& firstZone,Mtd& f
     firstMtd.vz = vi * sin(direction);
     firstMtd.v  = vi;
     firstMtd.av = qRound(avi / 100.0);
+    return true;
 }
 
-void FileParser::parseDataLine(const QStringList& values,std::vector<Coordinate>& coordinates){
+void FileParser::parseDataLine(const QStringList& values,RadarSamples& samples,
+                               quint32 lineNumber,const QString& line){
+    if (m_diagnostics)
+    {
+        double v[4];
+        if (!parseFields(values, 4, v, lineNumber, line))
+            return;
+
+        if (const int column = radarFieldOutOfRange(v))
+        {
+            m_diagnostics->reject(lineNumber, ParseDiagnostics::OutOfRange, column, line);
+            return;
+        }
+
+        if (samples.size() > 0 && v[3] < samples.t.back())
+        {
+            m_diagnostics->reject(lineNumber, ParseDiagnostics::TimeBackwards, 4, line);
+            return;
+        }
+
+        samples.push_back(v[0], v[1], v[2], v[3]);
+        return;
+    }
+
     if (values.size() < 4)
         return;
 
@@ -353,26 +328,7 @@ void FileParser::parseDataLine(const QStringList& values,std::vector<Coordinate>
     double eglob = values[2].toDouble(); //угол места
     double tglob = values[3].toDouble(); //время
 
-    double cosE = cos(eglob * KDU);
-    double sinE = sin(eglob * KDU);
-    double cosA = cos(aglob * KDU);
-    double sinA = sin(aglob * KDU);
-
-    Coordinate coord;
-    coord.X = dglob * cosE * cosA;
-    coord.Z = dglob * cosE * sinA;
-    double H = dglob * sinE + 0.6868e-7 * pow(dglob * cosE, 2);
-    coord.H = H;
-    coord.S = tglob;
-
-    // нужно переписать эту формулу?
-    coord.H_geo = ((g * m_latitude)/gc ) * ((rzem * H)/(rzem + H));
-
-    coord.dglob = dglob;
-    coord.aglob = aglob;
-    coord.eglob = eglob;
-
-    coordinates.push_back(coord);
+    samples.push_back(dglob, aglob, eglob, tglob);
 }
 
 bool FileParser::parseTemperatureCSV(const QString& fileName,
@@ -383,14 +339,19 @@ bool FileParser::parseTemperatureCSV(const QString& fileName,
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
         return false;
 
+    beginDiagnostics(fileName);
+
     QTextStream in(&file);
 
     int currentIndex = 1;   // начинаем с 1
     bool previousWasEmpty = false;
+    quint32 lineNumber = 0;
+    quint32 dataLines = 0;
 
     while (!in.atEnd())
     {
         QString line = in.readLine().trimmed();
+        ++lineNumber;
 
         if (line.isEmpty())
         {
@@ -404,22 +365,228 @@ bool FileParser::parseTemperatureCSV(const QString& fileName,
         }
 
         previousWasEmpty = false;
+        ++dataLines;
 
         QStringList values = line.split(',');
 
-        if (values.size() < 3)
-            continue;
-
         TemperatureRecord record;
-
         record.index = currentIndex;
-        record.QO    = values[0].toDouble();
-        record.QT    = values[1].toDouble();
-        record.dtp   = values[2].toDouble();
+
+        if (m_diagnostics)
+        {
+            // третий столбец (радиационная поправка) проверяется, только если он есть
+            double v[3]{};
+            if (!parseFields(values, values.size() >= 3 ? 3 : 2, v, lineNumber, line))
+                continue;
+
+            // сопротивления терморезистора
+            if (!(v[0] > 0) || !(v[1] > 0))
+            {
+                m_diagnostics->reject(lineNumber, ParseDiagnostics::OutOfRange, v[0] > 0 ? 2 : 1, line);
+                continue;
+            }
+
+            record.QO  = v[0];
+            record.QT  = v[1];
+            record.dtp = v[2];
+        }
+        else
+        {
+            // третий (готовая радиационная поправка) и четвертый (влажность) столбцы необязательны
+            if (values.size() < 2)
+                continue;
+
+            record.QO  = values[0].toDouble();
+            record.QT  = values[1].toDouble();
+            record.dtp = (values.size() >= 3) ? values[2].toDouble() : 0.0;
+        }
+
+        // четвертый столбец - влажность, %
+        if (values.size() >= 4)
+        {
+            bool ok = false;
+            const double u = values[3].toDouble(&ok);
+            if (ok && u >= 0 && u <= 100)
+                record.U = u;
+            else if (m_diagnostics)
+                m_diagnostics->note(lineNumber, ok ? ParseDiagnostics::OutOfRange : ParseDiagnostics::BadNumber, 4);
+        }
 
         records.push_back(record);
     }
 
     file.close();
+
+    if (m_diagnostics)
+        m_diagnostics->setLineCount(dataLines);
+
+    return true;
+}
+
+namespace {
+
+bool parseNumbers(const QString& line, int count, double* values)
+{
+    const QStringList items = line.split(',');
+    if (items.size() < count)
+        return false;
+
+    for (int i = 0; i < count; ++i)
+    {
+        bool ok = false;
+        values[i] = items[i].trimmed().toDouble(&ok);
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+// пределы, вне которых значение в файле зонда считается ошибкой
+QString checkSurfaceProbe(const SurfaceProbe& probe)
+{
+    const UserConstants& c = probe.constants;
+
+    if (c.A <= 0 || c.B <= 0 || c.R1 <= 0 || c.R2 < 0)
+        return "константы a, b, r1 должны быть положительными, r2 - неотрицательной";
+
+    if (c.T0 < -60 || c.T0 > 60)
+        return "T0 вне диапазона -60..60 °C";
+
+    if (c.U0 < 0 || c.U0 > 100)
+        return "U0 вне диапазона 0..100 %";
+
+    if (c.P0 < 500 || c.P0 > 1100)
+        return "P0 вне диапазона 500..1100 гПа";
+
+    for (const auto& [h, t] : probe.temperatureTable)
+    {
+        if (h < 0 || t < -100 || t > 60)
+            return QString("неверная строка таблицы: %1, %2").arg(h).arg(t);
+    }
+
+    return QString();
+}
+
+} // namespace
+
+bool FileParser::parseSurfaceProbe(const QString& fileName, SurfaceProbe& probe, QString* error)
+{
+    auto fail = [error](const QString& message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return fail("не удалось открыть файл");
+
+    QTextStream in(&file);
+
+    probe = SurfaceProbe{};
+
+    bool haveConstants = false;
+    bool haveSurface = false;
+    int lineNumber = 0;
+
+    while (!in.atEnd())
+    {
+        const QString line = in.readLine().trimmed();
+        ++lineNumber;
+
+        if (line.isEmpty())
+            continue;
+
+        const QString header = line.toLower().remove(" ");
+
+        // строка заголовка - значения в следующей строке
+        if (header == "a,b,c,r1,r2" || header == "t0,u0,p0")
+        {
+            const bool constants = header.startsWith("a");
+            const QString values = in.readLine().trimmed();
+            ++lineNumber;
+
+            double v[5]{};
+            if (!parseNumbers(values, constants ? 5 : 3, v))
+                return fail(QString("строка %1: ожидаются числа %2").arg(lineNumber).arg(line));
+
+            UserConstants& c = probe.constants;
+            if (constants)
+            {
+                c.A = v[0];
+                c.B = v[1];
+                c.C = v[2];
+                c.R1 = v[3];
+                c.R2 = v[4];
+                haveConstants = true;
+            }
+            else
+            {
+                c.T0 = v[0];
+                c.U0 = v[1];
+                c.P0 = v[2];
+                haveSurface = true;
+            }
+            continue;
+        }
+
+        // строка таблицы: подпись бюллетеня перед высотой не нужна
+        QString row = line;
+        const int space = int(row.lastIndexOf(' ', row.indexOf(',')));
+        if (space >= 0)
+            row = row.mid(space + 1);
+
+        double v[2]{};
+        if (!parseNumbers(row, 2, v))
+            return fail(QString("строка %1: неверная строка таблицы").arg(lineNumber));
+
+        probe.temperatureTable[v[0]] = v[1];
+    }
+
+    if (!haveConstants || !haveSurface)
+        return fail("нет строк a,b,c,r1,r2 или T0,U0,P0");
+
+    const QString problem = checkSurfaceProbe(probe);
+    if (!problem.isEmpty())
+        return fail(problem);
+
+    return true;
+}
+
+bool FileParser::loadSurfaceProbe(const QString& fileName, SurfaceProbe& probe, QString* error)
+{
+    struct Entry {
+        qint64 modified = 0;
+        qint64 size = 0;
+        SurfaceProbe probe;
+    };
+
+    static QMutex mutex;
+    static std::map<QString, Entry> cache;
+
+    const QFileInfo info(fileName);
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    const qint64 size = info.size();
+
+    {
+        QMutexLocker locker(&mutex);
+
+        auto it = cache.find(info.absoluteFilePath());
+        if (it != cache.end() && it->second.modified == modified && it->second.size == size)
+        {
+            probe = it->second.probe;
+            return true;
+        }
+    }
+
+    if (!parseSurfaceProbe(fileName, probe, error))
+        return false;
+
+    QMutexLocker locker(&mutex);
+    cache[info.absoluteFilePath()] = Entry{modified, size, probe};
+
     return true;
 }
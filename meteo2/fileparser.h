@@ -2,12 +2,28 @@
 #define FILEPARSER_H
 
 #include <QString>
+#include <map>
 #include <vector>
 #include "types.h"
+#include "radarsamples.h"
+#include "parsediagnostics.h"
+
+// Файл зонда (surface_probe.csv): константы терморезистора a,b,c,r1,r2,
+// наземные значения T0,U0,P0 и табличная температура по высотам
+// (строки вида "[Действ|Срдн] высота,температура").
+struct SurfaceProbe {
+    UserConstants constants{};
+    std::map<double, double> temperatureTable;
+};
 
 class FileParser
 {
 public:
+    // Проверяющий режим: строки логов и бюллетеней с ошибками не
+    // разбираются молча (пропуск, ноль вместо числа), а отбрасываются с
+    // замечанием в diagnostics. Каждый разбор начинает diagnostics заново.
+    // nullptr - обычный режим.
+    void setDiagnostics(ParseDiagnostics* diagnostics) { m_diagnostics = diagnostics; }
 
     bool parseTxtFile(const QString& fileName,
                       std::vector<Bull_mtd>& records);
@@ -17,13 +33,33 @@ public:
 
     bool parseCSV(const QString& fileName,std::vector<Coordinate>& coordinates,Zone& firstZone,Mtd& firstMtd);
 
+    // отсчеты РЛС по столбцам, без пересчета в координаты
+    bool parseRadarCSV(const QString& fileName,RadarSamples& samples,Zone& firstZone,Mtd& firstMtd);
+
     bool parseTemperatureCSV(const QString& fileName,std::vector<TemperatureRecord>& records);
 
+    // разбор и проверка файла зонда; причина ошибки - в error
+    bool parseSurfaceProbe(const QString& fileName, SurfaceProbe& probe, QString* error = nullptr);
+
+    // то же с кэшем: файл перечитывается, только если изменился
+    bool loadSurfaceProbe(const QString& fileName, SurfaceProbe& probe, QString* error = nullptr);
+
 
 private:
-    void parseFirstLine(const QStringList& values,Zone& firstZone,Mtd& firstMtd);
+    void beginDiagnostics(const QString& fileName);
+
+    // false - строка отброшена в проверяющем режиме
+    bool parseFirstLine(const QStringList& values,Zone& firstZone,Mtd& firstMtd,
+                        quint32 lineNumber,const QString& line);
+
+    void parseDataLine(const QStringList& values,RadarSamples& samples,
+                       quint32 lineNumber,const QString& line);
+
+    // разбор count полей строки в проверяющем режиме; false - строка отброшена
+    bool parseFields(const QStringList& values,int count,double* fields,
+                     quint32 lineNumber,const QString& line);
 
-    void parseDataLine(const QStringList& values,std::vector<Coordinate>& coordinates);
+    ParseDiagnostics* m_diagnostics = nullptr;
 };
 
 #endif
@@ -1,18 +0,0 @@
-#ifndef GLOBALS_H
-#define GLOBALS_H
-
-#include <map>
-
-// extern std::map<int, double> temperatureTable;
-
-extern double A = 1.0;
-extern double B = 4000.0;
-extern double C = 100.0;
-extern double R1 = 32.0;
-extern double R2 = 32.0;
-extern double T0 = 10.0;
-extern double U0 = 51.0;
-extern double P0 = 993.331;
-
-
-#endif
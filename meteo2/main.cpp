@@ -1,11 +1,107 @@
 #include "mainwindow.h"
+#include "batchrunner.h"
+#include "siteprofile.h"
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include <cstring>
+
+// meteo2 --batch <каталог архива> [--export <каталог> [--format csv,jsonl,columnar]] [--validate]:
+// обработка архива без окна
+static int runBatch(int argc, char *argv[], const char* archiveDir)
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setOrganizationName("meteo");
+    QCoreApplication::setApplicationName("meteo2");
+
+    SiteRegistry sites;
+    sites.loadStandardLocations();
+
+    QTextStream out(stdout);
+    for (const QString& error : sites.errors())
+        out << "профиль: " << error << Qt::endl;
+
+    BatchRunner runner(sites);
+
+    QString exportDir;
+    QString formats = "csv";
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--export") == 0)
+            exportDir = QString::fromLocal8Bit(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--format") == 0)
+            formats = QString::fromLocal8Bit(argv[i + 1]);
+    }
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--validate") == 0)
+            runner.setValidate(true);
+    }
+
+    if (!exportDir.isEmpty())
+    {
+        std::vector<ResultWriter::Format> exportFormats;
+        for (const QString& name : formats.split(',', Qt::SkipEmptyParts))
+        {
+            ResultWriter::Format format;
+            if (!ResultWriter::parseFormat(name, format))
+            {
+                out << "неизвестный формат выгрузки: " << name << Qt::endl;
+                return 2;
+            }
+            exportFormats.push_back(format);
+        }
+
+        runner.setExport(exportDir, exportFormats);
+    }
+
+    const std::vector<BatchRunner::Result> results = runner.run(QString::fromLocal8Bit(archiveDir));
+
+    int failed = 0;
+    for (const auto& r : results)
+    {
+        out << (r.ok ? "ok    " : "error ") << r.dir << " [" << r.site << "] " << r.message << Qt::endl;
+        if (!r.ok)
+            ++failed;
+    }
+
+    out << "зондирований: " << results.size() << ", ошибок: " << failed << Qt::endl;
+    return failed == 0 ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--batch") != 0)
+            continue;
+
+        // без каталога архива окно не открывается: запуск был пакетный
+        if (i + 1 == argc)
+        {
+            QTextStream err(stderr);
+            err << "не задан каталог архива" << Qt::endl
+                << "использование: meteo2 --batch <каталог архива>"
+                   " [--export <каталог> [--format csv,jsonl,columnar]] [--validate]" << Qt::endl;
+            return 2;
+        }
+
+        return runBatch(argc, argv, argv[i + 1]);
+    }
+
     QApplication a(argc, argv);
+    QApplication::setOrganizationName("meteo");
+    QApplication::setApplicationName("meteo2");
+
+    // профили мест читаются один раз при запуске
+    SiteRegistry sites;
+    sites.loadStandardLocations();
+
     MainWindow w;
+    w.setSiteRegistry(sites);
     w.setWindowTitle("meteo");
     w.setWindowIcon(QIcon(":/images/icon.png"));
     w.show();
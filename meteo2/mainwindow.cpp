@@ -11,6 +11,7 @@
 #include "analyzer.h"
 #include "types.h"
 #include "displaymanager.h"
+#include "pipeline.h"
 
 #include <vector>
 #include <array>
@@ -19,6 +20,11 @@
 
 
 #include <QMap>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QDir>
+#include <QApplication>
 #include <cmath>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -27,9 +33,15 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
+    // дисковый кэш этапов расчета
+    pipeline.setCacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pipeline");
+
     //устанавливаем размер окна "на весь экран"
     showMaximized();
 
+    // срок зондирования вводит оператор; по умолчанию - текущее время
+    ui->dateTimeEditSounding->setDateTime(QDateTime::currentDateTime());
+
     // запрещаем редактирование ячеек
     ui->TableMtd->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
@@ -60,6 +72,43 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->TableMtsResult, &QTableWidget::cellClicked,
             this, &MainWindow::onTableMtsResultClicked);
 
+    // живой пересчет: любое изменение констант на панели результатов
+    for (QDoubleSpinBox* box : {ui->liveSpinBoxA, ui->liveSpinBoxB, ui->liveSpinBoxC,
+                                ui->liveSpinBoxR1, ui->liveSpinBoxR2,
+                                ui->liveSpinBoxT0, ui->liveSpinBoxU0, ui->liveSpinBoxP0})
+    {
+        connect(box, &QDoubleSpinBox::valueChanged,
+                this, &MainWindow::onLiveConstantChanged);
+    }
+
+    // таблица зон: модель с копией zones, заголовок - с профилями столбцов
+    m_zoneModel = new ZoneTableModel(this);
+
+    m_zoneSort = new ZoneSortModel(this);
+    m_zoneSort->setSourceModel(m_zoneModel);
+
+    m_zoneHeader = new ZoneHeaderView(ui->tableViewZones);
+    ui->tableViewZones->setHorizontalHeader(m_zoneHeader);
+    ui->tableViewZones->setModel(m_zoneSort);
+    ui->tableViewZones->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->tableViewZones->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableViewZones->setSortingEnabled(true);
+
+    {
+        QSettings settings;
+        m_zoneHeader->setVisibleColumns(settings.value("zones/columns", ZoneTableModel::defaultColumns()).toStringList());
+    }
+
+    connect(m_zoneHeader, &ZoneHeaderView::visibleColumnsChanged,
+            this, &MainWindow::onZoneColumnsChanged);
+
+    // график профиля по высоте
+    m_profileChart = new ProfileChart(ui->tab_4);
+    ui->verticalLayoutProfile->addWidget(m_profileChart);
+
+    // встроенный профиль места, пока не переданы загруженные при запуске
+    fillSiteComboBox();
+
     //ui->lineEditMtd->setText("/Users/alinanovikova/Desktop/Бюллетень/mtd.txt");
     //ui->lineEditWind->setText("/Users/alinanovikova/Desktop/log_1.csv");
     //ui->lineEditTemp->setText("/Users/alinanovikova/Desktop/log_3.csv");
@@ -67,6 +116,12 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    if (m_fitThread)
+    {
+        m_fitThread->requestInterruption();
+        m_fitThread->wait();
+    }
+
     delete ui;
 }
 
@@ -90,6 +145,8 @@ void MainWindow::onTableCellEntered(int row, int column)
 
 void MainWindow::onTableMtdResultClicked(int row, int column)
 {
+    ensureSessionDetails();
+
     QTableWidget* table = qobject_cast<QTableWidget*>(sender()); //ссылка на таблицу
 
     if (!table)
@@ -174,6 +231,8 @@ void MainWindow::onTableMtdResultClicked(int row, int column)
 
 void MainWindow::onTableMtsResultClicked(int row, int column)
 {
+    ensureSessionDetails();
+
     QTableWidget* table = qobject_cast<QTableWidget*>(sender()); //ссылка на таблицу
 
     if (!table)
@@ -259,6 +318,8 @@ void MainWindow::onTableMtsResultClicked(int row, int column)
 
 void MainWindow::onTableMtdClicked(int row, int column)
 {
+    ensureSessionDetails();
+
     QTableWidget* table = qobject_cast<QTableWidget*>(sender()); //ссылка на таблицу
 
     if (!table)
@@ -343,6 +404,8 @@ void MainWindow::onTableMtdClicked(int row, int column)
 
 void MainWindow::onTableMtsClicked(int row, int column)
 {
+    ensureSessionDetails();
+
     QTableWidget* table = qobject_cast<QTableWidget*>(sender()); //ссылка на таблицу
 
     if (!table)
@@ -1006,12 +1069,51 @@ void MainWindow::on_pushButtonLoadTempLog_clicked() // обработка лог
     QMessageBox::information(this, "Файл загружен","Файл успешно выбран.");
 }
 
+void MainWindow::on_pushButtonLoadProbe_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(
+        this,
+        "Открыть файл зонда",
+        "",
+        "CSV files (*.csv)");
+
+    if (fileName.isEmpty())
+        return;
+
+    FileParser parser;
+    SurfaceProbe probe;
+    QString error;
+
+    if (!parser.loadSurfaceProbe(fileName, probe, &error))
+    {
+        QMessageBox::warning(this, "Ошибка", "Файл зонда: " + error);
+        return;
+    }
+
+    ui->lineEditProbe->setText(fileName);
+
+    ui->doubleSpinBoxA->setValue(probe.constants.A);
+    ui->doubleSpinBoxB->setValue(probe.constants.B);
+    ui->doubleSpinBoxC->setValue(probe.constants.C);
+    ui->doubleSpinBoxR1->setValue(probe.constants.R1);
+    ui->doubleSpinBoxR2->setValue(probe.constants.R2);
+
+    ui->doubleSpinBoxT0->setValue(probe.constants.T0);
+    ui->doubleSpinBoxU0->setValue(probe.constants.U0);
+    ui->doubleSpinBoxP0->setValue(probe.constants.P0);
+
+    m_probeTable = probe.temperatureTable;
+}
+
 void MainWindow::on_PushButtonBack_clicked(){
     ui->stackedWidget->setCurrentIndex(0);
 }
 
 void MainWindow::on_pushButtonCalculateTemp_clicked()
 {
+    // новый расчет отвязывает окно от открытого файла сессии
+    m_session.reset();
+
     // Очищаем все векторы перед новым расчетом
     coordinates.clear();
     zones.clear();
@@ -1019,83 +1121,59 @@ void MainWindow::on_pushButtonCalculateTemp_clicked()
     mts.clear();
     records.clear();  // если records является членом класса
 
-    // Или используйте reserve только после очистки
-    coordinates.reserve(10000);
-    zones.reserve(300);
-    mtd.reserve(30);
-    mts.reserve(30);
-
-    Zone firstZone(0.0);
-    Mtd firstMtd(4.0);
-
-    // уровни МДТ
-    const std::vector<double> heights = {
-        25, 75, 150, 300, 500, 700, 900,
-        1100, 1400, 1800, 2200, 2700,
-        3500, 4500, 5500, 7000, 9000,
-        11000, 13000, 16000, 20000,
-        24000, 28000
-    };
-
-    //заполнение МТД
-    for (double h : heights)
-        mtd.emplace_back(h);
-
-    // уровни МТС
-    const std::vector<double> h_mts = {
-        200, 400, 800, 1200, 1600,
-        2000, 2400, 3000, 4000, 5000,
-        6000, 8000, 10000, 12000, 14000,
-        18000, 22000, 26000, 30000
-    };
-
-    //заполнение МТС
-    for (double h : h_mts)
-        mts.emplace_back(h);
-
-    Analyzer analyzer;
-    FileParser parser;
-
-    if (!windLogFilePath.isEmpty())
+    if (windLogFilePath.isEmpty())
     {
-        if (!parser.parseCSV(windLogFilePath, coordinates, firstZone, firstMtd))
-        {
-            QMessageBox::critical(this,
-                                  "Ошибка",
-                                  "Не удалось открыть или прочитать лог ветра.");
-            return;
-        }
+        QMessageBox::warning(this,
+                             "Ошибка",
+                             "Сначала загрузите лог-файл.");
+        return;
     }
-    else
+
+    if (tempLogFilePath.isEmpty())
     {
         QMessageBox::warning(this,
                              "Ошибка",
-                             "Сначала загрузите лог-файл.");
+                             "Сначала загрузите log-файл.");
         return;
     }
 
-    zones.push_back(firstZone);
+    PipelineInput input;
 
-    // Обновляем первый уровень МДТ (вместо добавления нового)
-    if (!mtd.empty())
-        mtd[0] = firstMtd;
-    else
-        mtd.push_back(firstMtd);
+    input.windLogPath = windLogFilePath;
+    input.tempLogPath = tempLogFilePath;
 
-    zones.reserve(300);
+    if (!m_site)
+    {
+        QMessageBox::warning(this, "Ошибка", "Не выбран профиль места.");
+        return;
+    }
+
+    // уровни бюллетеней, сетка зон и таблицы - из профиля места
+    m_site->applyTo(input);
 
-    analyzer.createZones(zones, coordinates);
+    // таблица из файла зонда заменяет таблицу профиля
+    if (!m_probeTable.empty())
+        input.temperatureTable = m_probeTable;
 
-    analyzer.calculateVk(zones);
-    analyzer.calculateVi(zones, mtd);
-    analyzer.calculateV(mtd);
-    analyzer.calculateDHmtd(mtd);
-    analyzer.calculateDHmts(mts);
-    analyzer.calculateVm(zones, mts);
-    analyzer.calculateWm(mts);
+    input.smoothWindow = ui->doubleSpinBoxSmooth->value();
+    input.windLeastSquares = ui->checkBoxWindLsq->isChecked();
 
-    analyzer.createBullutin(mtd);
-    analyzer.createBullutinMts(mts);
+    input.sunElevation = ui->doubleSpinBoxSunElevation->value();
+
+    input.site.latitude = ui->doubleSpinBoxLatitude->value();
+    input.site.elevation = ui->doubleSpinBoxElevation->value();
+
+    // сетка зон: пустое поле - сетка профиля места
+    const QString gridSpec = ui->lineEditZoneGrid->text().trimmed();
+    if (!gridSpec.isEmpty())
+    {
+        QString error;
+        if (!ZoneGrid::parse(gridSpec, input.zoneGrid, &error))
+        {
+            QMessageBox::warning(this, "Ошибка", "Сетка зон: " + error);
+            return;
+        }
+    }
 
     // ТЕМПЕРАТУРА !!!!!!!!!!!!
     globalParam.A = ui->doubleSpinBoxA->value();
@@ -1104,22 +1182,33 @@ void MainWindow::on_pushButtonCalculateTemp_clicked()
     globalParam.R1 = ui->doubleSpinBoxR1->value();
     globalParam.R2 = ui->doubleSpinBoxR2->value();
 
-    globalParam.T0 = 10.0;
-    globalParam.U0 = 51.0;
-    globalParam.P0 = 993.331;
+    globalParam.T0 = ui->doubleSpinBoxT0->value();
+    globalParam.U0 = ui->doubleSpinBoxU0->value();
+    globalParam.P0 = ui->doubleSpinBoxP0->value();
 
     qDebug("A=%.2f B=%.2f C=%.2f R1=%.2f R2=%.2f", globalParam.A, globalParam.B, globalParam.C, globalParam.R1, globalParam.R2);
 
-    if (tempLogFilePath.isEmpty())
+    input.constants = globalParam;
+
+    // метаданные для сохранения сессии
+    m_sessionMeta = SessionMeta{};
+    m_sessionMeta.windLogPath = windLogFilePath;
+    m_sessionMeta.tempLogPath = tempLogFilePath;
+    m_sessionMeta.constants = globalParam;
+    m_sessionMeta.soundingTime = ui->dateTimeEditSounding->dateTime();
+
+    // пересчитываются только этапы, входы которых изменились
+    Pipeline::Status status = pipeline.run(input);
+
+    if (status == Pipeline::WindLogError)
     {
-        QMessageBox::warning(this,
-                             "Ошибка",
-                             "Сначала загрузите log-файл.");
+        QMessageBox::critical(this,
+                              "Ошибка",
+                              "Не удалось открыть или прочитать лог ветра.");
         return;
     }
 
-    // Пытаемся распарсить CSV
-    if (!parser.parseTemperatureCSV(tempLogFilePath, records))
+    if (status == Pipeline::TempLogError)
     {
         QMessageBox::critical(this,
                               "Ошибка",
@@ -1127,109 +1216,27 @@ void MainWindow::on_pushButtonCalculateTemp_clicked()
         return;
     }
 
-    const std::array<double, 51> Tvir = {
-        0.3, 0.3, 0.4, 0.4, 0.4,
-        0.5, 0.5, 0.6, 0.6, 0.7,
-        0.7, 0.8, 0.8, 0.8, 0.9,
-        0.9, 1.0, 1.0, 1.1, 1.2,
-        1.3, 1.4, 1.5, 1.6, 1.7,
-        1.8, 1.9, 2.0, 2.2, 2.3,
-        2.4, 2.55, 2.7, 2.9, 3.1,
-        3.3, 3.5, 3.7, 3.9, 4.15,
-        4.4, 4.65, 4.9, 5.2, 5.5,
-        5.8, 6.1, 6.4, 6.7, 7.05,
-        7.4
-    };
+    if (status == Pipeline::TempZoneMismatch)
+    {
+        QMessageBox::critical(this,
+                              "Ошибка",
+                              "Блоки лога температуры идут по стандартной сетке зон "
+                              "и не подходят к сетке " + input.zoneGrid.toString() + ".");
+        return;
+    }
+
+    // хэши логов - те, по которым шел расчет, а не на момент сохранения
+    m_sessionMeta.windLogHash = pipeline.windLogHash();
+    m_sessionMeta.tempLogHash = pipeline.tempLogHash();
+
+    coordinates = pipeline.coordinates();
+    zones = pipeline.zones();
+    mtd = pipeline.mtd();
+    mts = pipeline.mts();
+    records = pipeline.records();
 
-    std::map<double, double> temperatureTable = {
-                                                 {25.0,  15.75},
-                                                 {50.0,  15.6},
-                                                 {75.0,  15.45},
-                                                 {150.0,  14.95},
-                                                 {200.0,  15.3},
-                                                 {400.0,  14.0},
-                                                 {500.0,  12.7},
-                                                 {700.0,  11.4},
-                                                 {800.0,  12.1},
-                                                 {900.0, 10.2},
-                                                 {1100.0, 9.0},
-                                                 {1200.0, 9.6},
-                                                 {1600.0, 7.0},
-                                                 {2000.0, 4.5},
-                                                 {2400.0, 2.0},
-                                                 {3000.0, -1.2},
-                                                 {4000.0, -6.2},
-                                                 {5000.0, -12.6},
-                                                 {6000.0, -18.9},
-                                                 {8000.0, -28.4},
-                                                 {10000.0, -41.1},
-                                                 {12000.0, -50.4},
-                                                 {14000.0, -51.5},
-                                                 {16000.0, -51.5},
-                                                 {18000.0, -51.5},
-                                                 {20000.0, -51.5},
-                                                 };
-
-    std::map<double, double> DensityTable = {
-                                             {50.0, 1.2},
-                                             {75.0, 1.197},
-                                             {150.0, 1.188},
-                                             {500.0, 1.149},
-                                             {700.0, 1.127},
-                                             {900.0, 1.105},
-                                             {1100.0, 1.108},
-                                             };
-
-    // 0. Считаем толщину зоны
-    analyzer.calculateDeltaH(zones);
-
-    // 1. Считаем температуру для каждого измерения
-    analyzer.calculateT(records, globalParam);
-
-    // 2. Прибавляем радиационную поправку
-    analyzer.addRadio(records);
-
-    // 3. Температура для каждой зоны
-    analyzer.calculateTn(records, zones);
-
-    // 4. Вычисляем среднюю высоту зоны
-    analyzer.calculateMediumHeight(zones);
-
-    // 5. Вычисляем виртуальную поправку для каждой зоны
-    analyzer.calculateDTvir(zones, globalParam);
-
-    // 6. Прибавляем виртуальную поправку к температурам зон
-    analyzer.addVir(zones);
-
-    // 7. Вычисляем табличное значение температуры для средних высот зон
-    analyzer.fillTabTemperature(temperatureTable, zones);
-
-    // 8. Вычитаем табличное значение, получаем TTi
-    analyzer.calculateTTi(zones);
-
-    // 9. Вычисляем TTcpm для зон
-    analyzer.calculateTTcpm(zones);
-
-    // 10. Интерполяция, получаем значения для "метеодействительного"
-    analyzer.interpolateTemperatureToBullutin(zones, mtd);
-    analyzer.interpolateTemperatureToBullutin(zones, mts);
-
-    // Давление и плотность
-    // 1. Расчет табличной плотности для каждой зоны
-    analyzer.fillTabDensity(DensityTable, zones);
-
-    // 2. Расчет давления в зоне
-    analyzer.calculatePn(zones, globalParam);
-    analyzer.calculatePi(zones);
-    analyzer.calculatePPi(zones);
-    analyzer.calculatePPcpm(zones);
-
-    // Интерполяция плотности, получаем значения для "метеодействительного"
-    analyzer.interpolateDensityToBullutin(zones, mtd);
-    analyzer.interpolateDensityToBullutin(zones, mts);
-
-    //расчет вертикальной устойчивости для зон
-    analyzer.calculateTforR(zones);
+    ui->statusbar->showMessage(pipeline.summary());
+    qDebug() << "Этапы расчета:" << pipeline.summary();
 
     // Отладочный вывод (оставьте как есть)
     qDebug() << "---температура для каждой точки---";
@@ -1278,6 +1285,636 @@ void MainWindow::on_pushButtonCalculateTemp_clicked()
     setDataTableBullMtd(bull_mtd);
     setDataTableBullMts(bull_mts);
 
+    m_profileChart->setTrajectory(coordinates);
+    refreshZoneViews();
+
+    syncLiveSpinBoxes();
+
     // Переходим на страницу с таблицами
     ui->stackedWidget->setCurrentIndex(3);
 }
+
+void MainWindow::ensureSessionDetails()
+{
+    if (!m_session)
+        return;
+
+    bool loaded = false;
+
+    if (zones.empty() && m_session->hasSection(SessionFile::Zones))
+    {
+        m_session->loadZones(zones);
+        loaded = true;
+    }
+
+    if (coordinates.empty() && m_session->hasSection(SessionFile::Coordinates))
+    {
+        m_session->loadCoordinates(coordinates);
+        m_profileChart->setTrajectory(coordinates);
+        loaded = true;
+    }
+
+    if (loaded)
+        refreshZoneViews();
+}
+
+void MainWindow::on_pushButtonSaveSession_clicked()
+{
+    if (mtd.empty() && mts.empty())
+    {
+        QMessageBox::warning(this, "Ошибка", "Сначала выполните расчет.");
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        "Сохранить расчет",
+        "",
+        "Meteo session (*.msession)");
+
+    if (fileName.isEmpty())
+        return;
+
+    // все секции должны быть в памяти перед записью
+    ensureSessionDetails();
+
+    // хэши логов записаны при расчете (или взяты из открытой сессии)
+    SessionMeta meta = m_sessionMeta;
+    meta.created = QDateTime::currentDateTime();
+
+    if (!SessionFile::save(fileName, meta, coordinates, zones, mtd, mts, bull_mtd, bull_mts))
+    {
+        QMessageBox::critical(this, "Ошибка", "Не удалось сохранить файл расчета.");
+        return;
+    }
+
+    m_sessionMeta = meta;
+}
+
+void MainWindow::on_pushButtonSaveBulletins_clicked()
+{
+    if (mtd.empty() && mts.empty())
+    {
+        QMessageBox::warning(this, "Ошибка", "Сначала выполните расчет.");
+        return;
+    }
+
+    QString dir = QFileDialog::getExistingDirectory(this, "Папка для бюллетеней");
+    if (dir.isEmpty())
+        return;
+
+    // траектория нужна для высоты зондирования
+    ensureSessionDetails();
+
+    if (!m_site)
+    {
+        QMessageBox::warning(this, "Ошибка", "Не выбран профиль места.");
+        return;
+    }
+
+    // номер и координаты станции - из профиля места, высота - из поля ввода
+    BulletinWriter::Station station = m_site->station;
+    station.elevation = int(std::lround(ui->doubleSpinBoxElevation->value()));
+
+    // срок - из расчета, а не время записи бюллетеня
+    BulletinWriter::Surface surface;
+    surface.time = m_sessionMeta.soundingTime;
+    if (!surface.time.isValid())
+    {
+        // сессия сохранена без срока
+        const QDateTime time = ui->dateTimeEditSounding->dateTime();
+        if (QMessageBox::question(this, "Срок зондирования",
+                                  "В расчете не записан срок зондирования. Использовать "
+                                  + time.toString("dd.MM.yyyy HH:mm") + "?") != QMessageBox::Yes)
+            return;
+
+        surface.time = time;
+        m_sessionMeta.soundingTime = time;
+    }
+    surface.pressure = m_sessionMeta.constants.P0;
+    surface.virtualTemperature = VirtualCorrection(m_sessionMeta.constants).groundTemperature();
+
+    const std::vector<BulletinWriter::Sounding> soundings = {
+        {station, surface, &mtd, &mts, Analyzer::soundingTop(zones, coordinates, records)}
+    };
+
+    const QString mtdFile = QDir(dir).filePath("mtd.txt");
+    const QString m11File = QDir(dir).filePath("m11.txt");
+
+    if (!BulletinWriter::saveFile(mtdFile, BulletinWriter::writeBatch(soundings, BulletinCodec::Type::MeteoD))
+        || !BulletinWriter::saveFile(m11File, BulletinWriter::writeBatch(soundings, BulletinCodec::Type::Meteo11)))
+    {
+        QMessageBox::critical(this, "Ошибка", "Не удалось записать бюллетени.");
+        return;
+    }
+
+    ui->statusbar->showMessage("Бюллетени записаны: " + mtdFile + ", " + m11File);
+}
+
+void MainWindow::on_pushButtonArchive_clicked()
+{
+    QString dir = QFileDialog::getExistingDirectory(this, "Каталог с бюллетенями");
+    if (dir.isEmpty())
+        return;
+
+    // архив хранится между запусками, загружаются только новые файлы
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    const QString archiveFile = dataDir + "/bulletins.arc";
+
+    BulletinArchive archive;
+    archive.load(archiveFile);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const int added = archive.ingestDirectory(dir);
+    const bool saved = archive.save(archiveFile);
+    QApplication::restoreOverrideCursor();
+
+    if (!saved)
+        QMessageBox::warning(this, "Ошибка", "Не удалось сохранить архив бюллетеней.");
+
+    // файлы с ошибками не загружены и будут разобраны при следующей загрузке
+    if (!archive.errors().isEmpty())
+        QMessageBox::warning(this, "Архив бюллетеней",
+                             "Не загружены файлы:\n" + archive.errors().join("\n"));
+
+    ui->statusbar->showMessage(QString("Архив: добавлено бюллетеней %1, всего %2")
+                                   .arg(added)
+                                   .arg(archive.bulletinCount()));
+
+    // сравнение текущего расчета с бюллетенями за последний год
+    const QDateTime to = QDateTime::currentDateTimeUtc();
+    const QDateTime from = to.addYears(-1);
+
+    ui->TextBrowser->setHtml(displayManager.HtmlArchiveTTi(archive, mtd, from, to));
+}
+
+void MainWindow::on_pushButtonOpenSession_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(
+        this,
+        "Открыть сохраненный расчет",
+        "",
+        "Meteo session (*.msession)");
+
+    if (fileName.isEmpty())
+        return;
+
+    auto session = std::make_unique<SessionFile>();
+    SessionMeta meta;
+
+    if (!session->open(fileName) || !session->loadMeta(meta))
+    {
+        QMessageBox::critical(this, "Ошибка", "Не удалось открыть файл расчета.");
+        return;
+    }
+
+    coordinates.clear();
+    zones.clear();
+    mtd.clear();
+    mts.clear();
+    records.clear();
+    bull_mtd.clear();
+    bull_mts.clear();
+
+    // сразу читаем только то, что нужно для таблиц;
+    // зоны и координаты догружаются при первом клике по ячейке
+    session->loadMtd(mtd);
+    session->loadMts(mts);
+    session->loadBullMtd(bull_mtd);
+    session->loadBullMts(bull_mts);
+
+    m_session = std::move(session);
+    m_sessionMeta = meta;
+    globalParam = meta.constants;
+
+    windLogFilePath = meta.windLogPath;
+    tempLogFilePath = meta.tempLogPath;
+    if (meta.soundingTime.isValid())
+        ui->dateTimeEditSounding->setDateTime(meta.soundingTime);
+    ui->lineEditWind->setText(windLogFilePath);
+    ui->lineEditTemp->setText(tempLogFilePath);
+
+    ui->doubleSpinBoxA->setValue(globalParam.A);
+    ui->doubleSpinBoxB->setValue(globalParam.B);
+    ui->doubleSpinBoxC->setValue(globalParam.C);
+    ui->doubleSpinBoxR1->setValue(globalParam.R1);
+    ui->doubleSpinBoxR2->setValue(globalParam.R2);
+    ui->doubleSpinBoxT0->setValue(globalParam.T0);
+    ui->doubleSpinBoxU0->setValue(globalParam.U0);
+    ui->doubleSpinBoxP0->setValue(globalParam.P0);
+
+    syncLiveSpinBoxes();
+
+    setDataMtd(mtd);
+    setDataMts(mts);
+
+    setDataTableMtd(mtd);
+    setDataTableMts(mts);
+
+    setDataTableBullMtd(bull_mtd);
+    setDataTableBullMts(bull_mts);
+
+    // зоны и координаты сессии читаются при переходе на вкладку "Зоны" или "Профиль"
+    m_profileChart->setTrajectory(coordinates);
+    refreshZoneViews();
+
+    ui->stackedWidget->setCurrentIndex(3);
+}
+
+UserConstants MainWindow::liveConstants() const
+{
+    UserConstants constants;
+
+    constants.A  = ui->liveSpinBoxA->value();
+    constants.B  = ui->liveSpinBoxB->value();
+    constants.C  = ui->liveSpinBoxC->value();
+    constants.R1 = ui->liveSpinBoxR1->value();
+    constants.R2 = ui->liveSpinBoxR2->value();
+
+    constants.T0 = ui->liveSpinBoxT0->value();
+    constants.U0 = ui->liveSpinBoxU0->value();
+    constants.P0 = ui->liveSpinBoxP0->value();
+
+    return constants;
+}
+
+void MainWindow::syncLiveSpinBoxes()
+{
+    // копируем константы расчета на панель, не вызывая пересчет
+    const std::vector<std::pair<QDoubleSpinBox*, double>> values = {
+        {ui->liveSpinBoxA,  globalParam.A},
+        {ui->liveSpinBoxB,  globalParam.B},
+        {ui->liveSpinBoxC,  globalParam.C},
+        {ui->liveSpinBoxR1, globalParam.R1},
+        {ui->liveSpinBoxR2, globalParam.R2},
+        {ui->liveSpinBoxT0, globalParam.T0},
+        {ui->liveSpinBoxU0, globalParam.U0},
+        {ui->liveSpinBoxP0, globalParam.P0},
+    };
+
+    for (const auto& [box, value] : values)
+    {
+        QSignalBlocker blocker(box);
+        box->setValue(value);
+    }
+}
+
+void MainWindow::on_checkBoxLive_toggled(bool checked)
+{
+    if (checked)
+        onLiveConstantChanged();
+}
+
+void MainWindow::onLiveConstantChanged()
+{
+    if (!ui->checkBoxLive->isChecked())
+        return;
+
+    recalcFromLivePanel();
+}
+
+void MainWindow::recalcFromLivePanel()
+{
+    // для открытого файла сессии исходных измерений нет
+    if (m_session)
+    {
+        ui->statusbar->showMessage("Живой пересчет недоступен для сохраненного расчета");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const UserConstants constants = liveConstants();
+
+    if (!pipeline.updateConstants(constants))
+    {
+        ui->statusbar->showMessage("Сначала выполните расчет");
+        return;
+    }
+
+    const qint64 calcNs = timer.nsecsElapsed();
+
+    zones = pipeline.zones();
+    mtd = pipeline.mtd();
+    mts = pipeline.mts();
+
+    globalParam = constants;
+    m_sessionMeta.constants = constants;
+
+    // поля ввода на стартовой странице держим в соответствии с панелью
+    const std::vector<std::pair<QDoubleSpinBox*, double>> values = {
+        {ui->doubleSpinBoxA,  constants.A},
+        {ui->doubleSpinBoxB,  constants.B},
+        {ui->doubleSpinBoxC,  constants.C},
+        {ui->doubleSpinBoxR1, constants.R1},
+        {ui->doubleSpinBoxR2, constants.R2},
+        {ui->doubleSpinBoxT0, constants.T0},
+        {ui->doubleSpinBoxU0, constants.U0},
+        {ui->doubleSpinBoxP0, constants.P0},
+    };
+
+    for (const auto& [box, value] : values)
+    {
+        QSignalBlocker blocker(box);
+        box->setValue(value);
+    }
+
+    refreshResultTables();
+    refreshZoneViews();
+
+    ui->statusbar->showMessage(QString("Пересчет: %1 мкс, с обновлением таблиц: %2 мкс")
+                                   .arg(calcNs / 1000)
+                                   .arg(timer.nsecsElapsed() / 1000));
+}
+
+namespace {
+
+// перезаписывает текст ячеек столбцов TTi, TTcpm, PPi, PPcpm
+template<typename T>
+void refreshTemperatureColumns(QTableWidget& table, const std::vector<T>& data)
+{
+    for (int column = 0; column < table.columnCount(); ++column)
+    {
+        QTableWidgetItem* headerItem = table.horizontalHeaderItem(column);
+        if (!headerItem)
+            continue;
+
+        const QString header = headerItem->text();
+        double T::* field = nullptr;
+
+        if (header == "TTi")
+            field = &T::TTi;
+        else if (header == "TTcpm")
+            field = &T::TTcpm;
+        else if (header == "PPi")
+            field = &T::PPi;
+        else if (header == "PPcpm")
+            field = &T::PPcpm;
+
+        if (!field)
+            continue;
+
+        const int rows = std::min(table.rowCount(), static_cast<int>(data.size()));
+
+        for (int row = 0; row < rows; ++row)
+        {
+            if (QTableWidgetItem* item = table.item(row, column))
+                item->setText(QString::number(data[row].*field, 'f', 2));
+        }
+    }
+}
+
+} // namespace
+
+void MainWindow::refreshResultTables()
+{
+    refreshTemperatureColumns(*ui->TableMtd, mtd);
+    refreshTemperatureColumns(*ui->TableMts, mts);
+    refreshTemperatureColumns(*ui->TableMtdResult, mtd);
+    refreshTemperatureColumns(*ui->TableMtsResult, mts);
+
+    compareVColumns(*ui->TableMtdResult, *ui->TableMtdBull);
+    compareVColumns(*ui->TableMtsResult, *ui->TableMtsBull);
+}
+
+void MainWindow::refreshZoneViews()
+{
+    m_zoneModel->setZones(zones);
+    m_profileChart->setZones(zones);
+
+    const int unstable = m_zoneModel->unstableCount();
+    ui->labelUnstable->setText(unstable == 0 ? QString()
+                                             : QString("Неустойчивых слоев (Ri < %1): %2")
+                                                   .arg(ZoneTableModel::CriticalRi)
+                                                   .arg(unstable));
+}
+
+void MainWindow::on_tabWidget_currentChanged(int index)
+{
+    if (ui->tabWidget->widget(index) == ui->tab_3 || ui->tabWidget->widget(index) == ui->tab_4)
+        ensureSessionDetails();
+}
+
+void MainWindow::on_pushButtonExportZones_clicked()
+{
+    ensureSessionDetails();
+
+    if (zones.empty())
+    {
+        QMessageBox::warning(this, "Ошибка", "Нет рассчитанных зон.");
+        return;
+    }
+
+    // видимые столбцы в порядке модели
+    std::vector<int> columns;
+    for (int c = 0; c < m_zoneModel->columnCount(); ++c)
+    {
+        if (!m_zoneHeader->isSectionHidden(c))
+            columns.push_back(c);
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        "Экспорт зон",
+        "zones.csv",
+        "CSV (*.csv)");
+
+    if (fileName.isEmpty())
+        return;
+
+    if (!m_zoneModel->exportCsv(fileName, columns))
+    {
+        QMessageBox::critical(this, "Ошибка", "Не удалось записать файл зон.");
+        return;
+    }
+
+    ui->statusbar->showMessage("Зоны сохранены: " + fileName);
+}
+
+void MainWindow::onZoneColumnsChanged()
+{
+    QSettings settings;
+    settings.setValue("zones/columns", m_zoneHeader->visibleColumns());
+}
+
+void MainWindow::on_pushButtonFit_clicked()
+{
+    // повторное нажатие останавливает подбор
+    if (m_fitThread)
+    {
+        m_fitThread->requestInterruption();
+        return;
+    }
+
+    if (m_session || pipeline.zones().empty())
+    {
+        QMessageBox::warning(this, "Ошибка", "Сначала выполните расчет.");
+        return;
+    }
+
+    if (bull_mtd.empty())
+    {
+        QMessageBox::warning(this, "Ошибка", "Сначала загрузите бюллетень \"Метеодействительный\".");
+        return;
+    }
+
+    // подбор работает на своей копии зон и измерений
+    auto fitter = std::make_shared<CoefficientFitter>(pipeline.zones(), pipeline.zoneSamples(), bull_mtd);
+    const UserConstants start = liveConstants();
+
+    if (fitter->targetCount() == 0)
+    {
+        QMessageBox::warning(this, "Ошибка", "В бюллетене нет уровней для сравнения.");
+        return;
+    }
+
+    ui->pushButtonFit->setText("Остановить подбор");
+
+    m_fitThread = QThread::create([this, fitter, start]()
+    {
+        auto progress = [this](const CoefficientFitter::Progress& p)
+        {
+            QMetaObject::invokeMethod(this, [this, p]()
+            {
+                ui->statusbar->showMessage(QString("Подбор: итерация %1, вычислений %2, СКО TTi %3")
+                                               .arg(p.iteration)
+                                               .arg(p.evaluations)
+                                               .arg(p.rms, 0, 'f', 3));
+            }, Qt::QueuedConnection);
+
+            return !QThread::currentThread()->isInterruptionRequested();
+        };
+
+        const CoefficientFitter::Result result = fitter->fit(start, progress);
+
+        QMetaObject::invokeMethod(this, [this, result]()
+        {
+            onFitFinished(result);
+        }, Qt::QueuedConnection);
+    });
+
+    connect(m_fitThread, &QThread::finished, m_fitThread, &QObject::deleteLater);
+    m_fitThread->start();
+}
+
+void MainWindow::onFitFinished(const CoefficientFitter::Result& result)
+{
+    m_fitThread = nullptr;
+    ui->pushButtonFit->setText("Подобрать коэффициенты");
+
+    // подставляем найденные константы на панель и пересчитываем таблицы
+    const std::vector<std::pair<QDoubleSpinBox*, double>> values = {
+        {ui->liveSpinBoxA,  result.constants.A},
+        {ui->liveSpinBoxB,  result.constants.B},
+        {ui->liveSpinBoxC,  result.constants.C},
+        {ui->liveSpinBoxR1, result.constants.R1},
+        {ui->liveSpinBoxR2, result.constants.R2},
+    };
+
+    for (const auto& [box, value] : values)
+    {
+        QSignalBlocker blocker(box);
+        box->setValue(value);
+    }
+
+    recalcFromLivePanel();
+
+    QString state = result.converged ? "сошелся"
+                    : result.cancelled ? "остановлен"
+                                       : "достигнут предел итераций";
+
+    QMessageBox::information(this, "Подбор коэффициентов",
+                             QString("Подбор %1.\n"
+                                     "Итераций: %2, вычислений: %3\n"
+                                     "СКО TTi: %4 -> %5\n\n"
+                                     "A=%6 B=%7 C=%8 R1=%9 R2=%10")
+                                 .arg(state)
+                                 .arg(result.iterations)
+                                 .arg(result.evaluations)
+                                 .arg(result.startRms, 0, 'f', 3)
+                                 .arg(result.rms, 0, 'f', 3)
+                                 .arg(result.constants.A, 0, 'f', 4)
+                                 .arg(result.constants.B, 0, 'f', 4)
+                                 .arg(result.constants.C, 0, 'f', 4)
+                                 .arg(result.constants.R1, 0, 'f', 4)
+                                 .arg(result.constants.R2, 0, 'f', 4));
+}
+
+void MainWindow::setSiteRegistry(const SiteRegistry& sites)
+{
+    m_sites = sites;
+
+    for (const QString& error : m_sites.errors())
+        qDebug() << "Профиль места не загружен:" << error;
+
+    fillSiteComboBox();
+}
+
+void MainWindow::fillSiteComboBox()
+{
+    // последнее выбранное место
+    QSettings settings;
+    const QString current = settings.value("site/current", SiteRegistry::DefaultId).toString();
+
+    int index = 0;
+    {
+        QSignalBlocker blocker(ui->comboBoxSite);
+        ui->comboBoxSite->clear();
+
+        for (const SiteProfilePtr& profile : m_sites.profiles())
+        {
+            if (profile->id == current)
+                index = ui->comboBoxSite->count();
+
+            ui->comboBoxSite->addItem(profile->site.name, profile->id);
+        }
+
+        ui->comboBoxSite->setCurrentIndex(index);
+    }
+
+    on_comboBoxSite_currentIndexChanged(ui->comboBoxSite->currentIndex());
+}
+
+void MainWindow::on_comboBoxSite_currentIndexChanged(int index)
+{
+    if (index < 0)
+        return;
+
+    SiteProfilePtr profile = m_sites.find(ui->comboBoxSite->itemData(index).toString());
+    if (!profile)
+        return;
+
+    m_site = profile;
+    applySiteProfile(*m_site);
+
+    // файл зонда относится к прежнему месту
+    m_probeTable.clear();
+    ui->lineEditProbe->clear();
+
+    QSettings settings;
+    settings.setValue("site/current", m_site->id);
+}
+
+void MainWindow::applySiteProfile(const SiteProfile& profile)
+{
+    ui->doubleSpinBoxLatitude->setValue(profile.site.latitude);
+    ui->doubleSpinBoxElevation->setValue(profile.site.elevation);
+
+    ui->doubleSpinBoxA->setValue(profile.constants.A);
+    ui->doubleSpinBoxB->setValue(profile.constants.B);
+    ui->doubleSpinBoxC->setValue(profile.constants.C);
+    ui->doubleSpinBoxR1->setValue(profile.constants.R1);
+    ui->doubleSpinBoxR2->setValue(profile.constants.R2);
+
+    ui->doubleSpinBoxT0->setValue(profile.constants.T0);
+    ui->doubleSpinBoxU0->setValue(profile.constants.U0);
+    ui->doubleSpinBoxP0->setValue(profile.constants.P0);
+
+    // пустая сетка в поле - сетка профиля
+    ui->lineEditZoneGrid->setPlaceholderText(profile.zoneGrid.toString());
+
+    // высота солнца нужна только для таблицы радиационных поправок
+    ui->doubleSpinBoxSunElevation->setEnabled(profile.radiationTable != nullptr);
+}
@@ -83,6 +83,9 @@ private:
     // путь к температурному лог-файлу
     QString tempLogFilePath;
 
+    // табличная температура из файла зонда (пусто - из профиля места)
+    std::map<double, double> m_probeTable;
+
     TableClickInfo m_lastClickInfo; //
 
 signals:
@@ -100,10 +103,21 @@ signals:
 #include <QString>
 #include <QDateTime>
 #include <vector>
+#include <map>
+#include <memory>
 
 #include "types.h"
 #include "displaymanager.h"
+#include "sessionfile.h"
+#include "pipeline.h"
+#include "coefficientfitter.h"
+#include "bulletinwriter.h"
+#include "siteprofile.h"
+#include "zonetablemodel.h"
+#include "zoneheaderview.h"
+#include "profilechart.h"
 #include <QTableWidget>
+#include <QThread>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -145,6 +159,9 @@ public:
     // пока что
     TableClickInfo getLastClickInfo() const { return m_lastClickInfo; }
 
+    // профили мест, загруженные при запуске
+    void setSiteRegistry(const SiteRegistry& sites);
+
 private slots:
 
     void on_pushButtonLoadMtd_clicked();
@@ -161,6 +178,9 @@ private slots:
     void on_pushButtonLoadTempLog_clicked();
     void on_pushButtonCalculateTemp_clicked();
 
+    // Файл зонда: константы, наземные значения и табличная температура
+    void on_pushButtonLoadProbe_clicked();
+
     // Создание таблиц бюллетеней
     void setDataMtd(const std::vector<Mtd>& data);
     void setDataMts(const std::vector<Mts>& data);
@@ -188,7 +208,54 @@ private slots:
     // Кнопки "назад"
     void on_PushButtonBack_clicked();
 
+    // Сохранение и открытие рассчитанной сессии
+    void on_pushButtonSaveSession_clicked();
+
+    // Запись бюллетеней МЕТЕОД и МЕТЕО-11 по результатам расчета
+    void on_pushButtonSaveBulletins_clicked();
+
+    // Загрузка каталога бюллетеней в архив и сравнение с расчетом
+    void on_pushButtonArchive_clicked();
+    void on_pushButtonOpenSession_clicked();
+
+    // Живой пересчет температурной ветви при изменении констант
+    void on_checkBoxLive_toggled(bool checked);
+    void onLiveConstantChanged();
+
+    // Подбор констант терморезистора по бюллетеню
+    void on_pushButtonFit_clicked();
+
+    // Смена места зондирования
+    void on_comboBoxSite_currentIndexChanged(int index);
+
+    // Вкладки "Зоны" и "Профиль": таблица зон с устойчивостью, ее экспорт и график
+    void on_tabWidget_currentChanged(int index);
+    void on_pushButtonExportZones_clicked();
+    void onZoneColumnsChanged();
+
 private:
+    // догружает из файла сессии зоны и координаты для окна детализации
+    void ensureSessionDetails();
+
+    // константы с панели живого пересчета и синхронизация с вводом
+    UserConstants liveConstants() const;
+    void syncLiveSpinBoxes();
+
+    // пересчет по константам с панели и обновление таблиц
+    void recalcFromLivePanel();
+
+    void onFitFinished(const CoefficientFitter::Result& result);
+
+    // обновляет столбцы температуры и плотности в уже заполненных таблицах
+    void refreshResultTables();
+
+    // таблица зон, число неустойчивых слоев и график профиля
+    void refreshZoneViews();
+
+    // список мест и перенос значений профиля в поля ввода
+    void fillSiteComboBox();
+    void applySiteProfile(const SiteProfile& profile);
+
     Ui::MainWindow *ui;
 
     std::vector<Coordinate> coordinates;
@@ -211,9 +278,34 @@ private:
     // путь к температурному лог-файлу
     QString tempLogFilePath;
 
+    // табличная температура из файла зонда (пусто - из профиля места)
+    std::map<double, double> m_probeTable;
+
     TableClickInfo m_lastClickInfo;
     DisplayManager displayManager;
 
+    // цепочка расчета с кэшированием этапов
+    Pipeline pipeline;
+
+    // профили мест и выбранный профиль
+    SiteRegistry m_sites;
+    SiteProfilePtr m_site;
+
+    // модель вкладки "Зоны" (читает вектор zones) и сортировка
+    ZoneTableModel* m_zoneModel = nullptr;
+    ZoneSortModel* m_zoneSort = nullptr;
+    ZoneHeaderView* m_zoneHeader = nullptr;
+
+    // вкладка "Профиль"
+    ProfileChart* m_profileChart = nullptr;
+
+    // фоновый подбор констант (nullptr, если не идет)
+    QThread* m_fitThread = nullptr;
+
+    // открытый файл сессии (секции читаются по мере надобности)
+    std::unique_ptr<SessionFile> m_session;
+    SessionMeta m_sessionMeta;
+
 signals:
     void tableCellClicked(const TableClickInfo& info);
 
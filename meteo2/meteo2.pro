@@ -4,23 +4,65 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# векторизация циклов с #pragma omp simd (без подключения OpenMP)
+gcc|clang: QMAKE_CXXFLAGS += -fopenmp-simd
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
     analyzer.cpp \
+    batchrunner.cpp \
+    bulletinarchive.cpp \
+    bulletincodec.cpp \
+    bulletinwriter.cpp \
+    coefficientfitter.cpp \
     displaymanager.cpp \
     fileparser.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    parsediagnostics.cpp \
+    pipeline.cpp \
+    profilechart.cpp \
+    radarsamples.cpp \
+    radiationtable.cpp \
+    resultwriter.cpp \
+    sessionfile.cpp \
+    siteconfig.cpp \
+    siteprofile.cpp \
+    trajectory.cpp \
+    virtualcorrection.cpp \
+    zonegrid.cpp \
+    zoneheaderview.cpp \
+    zonetablemodel.cpp
 
 HEADERS += \
     analyzer.h \
+    batchrunner.h \
+    bulletinarchive.h \
+    bulletincodec.h \
+    bulletinwriter.h \
+    coefficientfitter.h \
     displaymanager.h \
     fileparser.h \
     mainwindow.h \
-    types.h
+    parsediagnostics.h \
+    pipeline.h \
+    profilechart.h \
+    radarsamples.h \
+    radiationtable.h \
+    resultwriter.h \
+    sessionfile.h \
+    siteconfig.h \
+    siteprofile.h \
+    trajectory.h \
+    types.h \
+    typesio.h \
+    virtualcorrection.h \
+    zonegrid.h \
+    zoneheaderview.h \
+    zonetablemodel.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,130 @@
+#include "parsediagnostics.h"
+
+#include <QStringList>
+
+const char* ParseDiagnostics::reasonText(Reason reason)
+{
+    switch (reason)
+    {
+    case TooFewFields:  return "мало полей";
+    case BadNumber:     return "поле не число";
+    case OutOfRange:    return "значение вне пределов";
+    case TimeBackwards: return "время идет назад";
+    case BadBulletin:   return "ошибка в бюллетене";
+    case MissingGroup:  return "пропущенная группа";
+    case ReasonCount:   break;
+    }
+
+    return "";
+}
+
+void ParseDiagnostics::clear()
+{
+    m_fileName.clear();
+    m_lines = 0;
+    m_issues.clear();
+    m_quarantine.clear();
+    m_counts.fill(0);
+}
+
+void ParseDiagnostics::reject(quint32 line, Reason reason, int column, const QString& text)
+{
+    m_issues.push_back({line, reason, quint8(column), true});
+    m_quarantine.push_back(text.toUtf8());
+    ++m_counts[reason];
+}
+
+void ParseDiagnostics::note(quint32 line, Reason reason, int column)
+{
+    m_issues.push_back({line, reason, quint8(column), false});
+    ++m_counts[reason];
+}
+
+QString ParseDiagnostics::summary() const
+{
+    QString text = QString("принято %1 из %2 строк").arg(accepted()).arg(m_lines);
+
+    QStringList reasons;
+    for (int i = 0; i < ReasonCount; ++i)
+    {
+        if (m_counts[i] > 0)
+            reasons << QString("%1: %2").arg(reasonText(Reason(i))).arg(m_counts[i]);
+    }
+
+    if (!reasons.isEmpty())
+        text += " (" + reasons.join(", ") + ")";
+
+    return text;
+}
+
+void ParseDiagnostics::appendQuarantine(QByteArray& out) const
+{
+    const QByteArray file = m_fileName.toUtf8();
+    size_t next = 0;
+
+    for (const Issue& issue : m_issues)
+    {
+        if (!issue.rejected)
+            continue;
+
+        out += file;
+        out += ':';
+        out += QByteArray::number(issue.line);
+        out += ": ";
+        out += reasonText(issue.reason);
+        if (issue.column > 0)
+        {
+            out += ", поле ";
+            out += QByteArray::number(issue.column);
+        }
+        out += '\t';
+        out += m_quarantine[next++];
+        out += '\n';
+    }
+}
+
+void ParseDiagnostics::write(QDataStream& out) const
+{
+    out << m_lines << quint32(m_issues.size());
+
+    size_t next = 0;
+    for (const Issue& issue : m_issues)
+    {
+        out << issue.line << quint8(issue.reason) << issue.column << issue.rejected;
+        if (issue.rejected)
+            out << m_quarantine[next++];
+    }
+}
+
+bool ParseDiagnostics::read(QDataStream& in)
+{
+    const QString fileName = m_fileName;
+    clear();
+    m_fileName = fileName;
+
+    quint32 count = 0;
+    in >> m_lines >> count;
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        Issue issue{};
+        quint8 reason = 0;
+        in >> issue.line >> reason >> issue.column >> issue.rejected;
+
+        if (reason >= ReasonCount)
+            return false;
+        issue.reason = Reason(reason);
+
+        if (issue.rejected)
+        {
+            QByteArray text;
+            in >> text;
+            m_quarantine.push_back(text);
+        }
+
+        m_issues.push_back(issue);
+        ++m_counts[issue.reason];
+    }
+
+    return in.status() == QDataStream::Ok;
+}
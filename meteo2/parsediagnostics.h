@@ -0,0 +1,80 @@
+#ifndef PARSEDIAGNOSTICS_H
+#define PARSEDIAGNOSTICS_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <array>
+#include <vector>
+
+// Замечания к строкам входного файла в проверяющем режиме разбора
+// (FileParser::setDiagnostics).
+//
+// Хранятся только строки с замечаниями: номер строки, причина и поле -
+// 8 байт на замечание; текст сохраняется лишь у отброшенных строк
+// (карантин). Для правильных строк разбор ничего сюда не пишет.
+class ParseDiagnostics
+{
+public:
+    enum Reason : quint8 {
+        TooFewFields,   // мало полей в строке
+        BadNumber,      // поле не число
+        OutOfRange,     // значение вне допустимых пределов
+        TimeBackwards,  // время меньше, чем в предыдущей строке
+        BadBulletin,    // бюллетень не разбирается
+        MissingGroup,   // пропущенная группа бюллетеня "//////"
+        ReasonCount
+    };
+
+    struct Issue {
+        quint32 line;     // номер строки файла с 1; 0 - без привязки к строке
+        Reason reason;
+        quint8 column;    // номер поля с 1; 0 - вся строка
+        bool rejected;    // строка отброшена и попала в карантин
+    };
+
+    static const char* reasonText(Reason reason);
+
+    void clear();
+
+    void setFileName(const QString& fileName) { m_fileName = fileName; }
+    const QString& fileName() const { return m_fileName; }
+
+    // строка отброшена: замечание и текст строки в карантин
+    void reject(quint32 line, Reason reason, int column, const QString& text);
+    // строка принята, но с замечанием
+    void note(quint32 line, Reason reason, int column);
+
+    // число непустых строк данных в файле
+    void setLineCount(quint32 lines) { m_lines = lines; }
+
+    quint32 lines() const { return m_lines; }
+    quint32 rejected() const { return quint32(m_quarantine.size()); }
+    quint32 accepted() const { return m_lines > rejected() ? m_lines - rejected() : 0; }
+    quint32 count(Reason reason) const { return m_counts[reason]; }
+
+    bool isClean() const { return m_issues.empty(); }
+    const std::vector<Issue>& issues() const { return m_issues; }
+
+    // "принято 8890 из 8892 строк (поле не число: 1, мало полей: 1)"
+    QString summary() const;
+
+    // отброшенные строки для файла карантина:
+    // "файл:строка: причина, поле N<TAB>текст строки"
+    void appendQuarantine(QByteArray& out) const;
+
+    // для дискового кэша этапов разбора (имя файла не пишется)
+    void write(QDataStream& out) const;
+    bool read(QDataStream& in);
+
+private:
+    QString m_fileName;
+    quint32 m_lines = 0;
+
+    std::vector<Issue> m_issues;
+    // тексты отброшенных строк в порядке замечаний с rejected
+    std::vector<QByteArray> m_quarantine;
+    std::array<quint32, ReasonCount> m_counts{};
+};
+
+#endif // PARSEDIAGNOSTICS_H
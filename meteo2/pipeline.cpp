@@ -0,0 +1,582 @@
+#include "pipeline.h"
+#include "analyzer.h"
+#include "fileparser.h"
+#include "sessionfile.h"
+#include "typesio.h"
+#include "virtualcorrection.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+
+#include <algorithm>
+
+namespace {
+
+// Версия алгоритма каждого этапа. Увеличивать при изменении расчета
+// этапа, чтобы старые результаты в дисковом кэше не использовались.
+constexpr std::array<quint32, Pipeline::StageCount> StageVersion = {4, 3, 4, 7};
+
+constexpr const char* StageName[Pipeline::StageCount] = {
+    "wind-parse", "wind-calc", "temp-parse", "temperature"
+};
+
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+// сколько файлов оставлять в дисковом кэше
+constexpr int CacheLimit = 64;
+
+class KeyBuilder
+{
+public:
+    explicit KeyBuilder(Pipeline::Stage stage)
+        : m_hash(QCryptographicHash::Sha1)
+    {
+        add(QByteArray(StageName[stage]));
+        add(double(StageVersion[stage]));
+    }
+
+    void add(const QByteArray& bytes)
+    {
+        add(double(bytes.size()));
+        m_hash.addData(bytes.constData(), bytes.size());
+    }
+
+    void add(double value)
+    {
+        m_hash.addData(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void add(const std::vector<double>& values)
+    {
+        add(double(values.size()));
+        for (double v : values)
+            add(v);
+    }
+
+    void add(const std::map<double, double>& table)
+    {
+        add(double(table.size()));
+        for (const auto& [h, v] : table)
+        {
+            add(h);
+            add(v);
+        }
+    }
+
+    void add(const ZoneGrid& grid)
+    {
+        add(double(grid.bands().size()));
+        for (const auto& band : grid.bands())
+        {
+            add(double(band.from));
+            add(double(band.to));
+            add(double(band.step));
+        }
+    }
+
+    void add(const UserConstants& c)
+    {
+        for (auto field : FieldTable<UserConstants>::fields)
+            add(c.*field);
+    }
+
+    QByteArray result() const { return m_hash.result(); }
+
+private:
+    QCryptographicHash m_hash;
+};
+
+} // namespace
+
+Pipeline::Status Pipeline::run(const PipelineInput& input)
+{
+    m_source.fill(Memory);
+
+    // до успешного конца запуска живой пересчет недоступен
+    m_temperatureValid = false;
+
+    const QByteArray windFileHash = SessionFile::fileHash(input.windLogPath);
+    if (windFileHash.isEmpty())
+        return WindLogError;
+
+    const QByteArray tempFileHash = SessionFile::fileHash(input.tempLogPath);
+    if (tempFileHash.isEmpty())
+        return TempLogError;
+
+    // ключи этапов в порядке зависимостей
+    std::array<QByteArray, StageCount> keys;
+
+    KeyBuilder windParse(WindParse);
+    windParse.add(windFileHash);
+    windParse.add(input.smoothWindow);
+    windParse.add(double(input.geopotential));
+    windParse.add(input.site.latitude);
+    windParse.add(input.site.elevation);
+    windParse.add(input.site.earthRadius);
+    windParse.add(input.validate ? 1.0 : 0.0);
+    keys[WindParse] = windParse.result();
+
+    KeyBuilder windCalc(WindCalc);
+    windCalc.add(keys[WindParse]);
+    windCalc.add(input.mtdLevels);
+    windCalc.add(input.mtsLevels);
+    windCalc.add(input.zoneGrid);
+    windCalc.add(input.windLeastSquares ? 1.0 : 0.0);
+    keys[WindCalc] = windCalc.result();
+
+    KeyBuilder tempParse(TempParse);
+    tempParse.add(tempFileHash);
+    tempParse.add(input.validate ? 1.0 : 0.0);
+    keys[TempParse] = tempParse.result();
+
+    KeyBuilder temperature(Temperature);
+    temperature.add(keys[WindCalc]);
+    temperature.add(keys[TempParse]);
+    temperature.add(input.constants);
+    temperature.add(input.temperatureTable);
+    temperature.add(input.densityTable);
+
+    // радиационные поправки меняют записи зон, а с ними и группировку
+    KeyBuilder radiation(Temperature);
+    if (input.radiationTable)
+    {
+        radiation.add(input.radiationTable->heights());
+        radiation.add(input.radiationTable->elevations());
+        radiation.add(input.radiationTable->values());
+        radiation.add(input.sunElevation);
+    }
+    m_radiationKey = radiation.result();
+
+    temperature.add(m_radiationKey);
+    keys[Temperature] = temperature.result();
+
+    for (int i = 0; i < StageCount; ++i)
+    {
+        Stage stage = static_cast<Stage>(i);
+
+        if (keys[stage] == m_keys[stage])
+            continue;
+
+        // сбрасываем ключ, чтобы при ошибке этап не считался готовым
+        m_keys[stage].clear();
+
+        if (stage == Temperature && !tempBlocksMatchZones(input))
+            return TempZoneMismatch;
+
+        if (loadCached(stage, keys[stage]))
+        {
+            m_source[stage] = Disk;
+        }
+        else
+        {
+            switch (stage)
+            {
+            case WindParse:
+                if (!computeWindParse(input))
+                    return WindLogError;
+                break;
+            case WindCalc:
+                computeWindCalc(input);
+                break;
+            case TempParse:
+                if (!computeTempParse(input))
+                    return TempLogError;
+                break;
+            case Temperature:
+                computeTemperature(input);
+                break;
+            default:
+                break;
+            }
+
+            m_source[stage] = Computed;
+            storeCached(stage, keys[stage]);
+        }
+
+        m_keys[stage] = keys[stage];
+    }
+
+    // ключи этапов от пути не зависят: имя файла в замечаниях - текущее
+    m_windDiagnostics.setFileName(input.windLogPath);
+    m_tempDiagnostics.setFileName(input.tempLogPath);
+
+    m_windLogHash = windFileHash;
+    m_tempLogHash = tempFileHash;
+
+    pruneCache();
+
+    m_temperatureValid = true;
+    return Ok;
+}
+
+QString Pipeline::summary() const
+{
+    QStringList parts;
+
+    for (int i = 0; i < StageCount; ++i)
+    {
+        QString source;
+        switch (m_source[i])
+        {
+        case Memory:   source = "без изменений"; break;
+        case Disk:     source = "из кэша"; break;
+        case Computed: source = "пересчитан"; break;
+        }
+
+        parts << QString("%1: %2").arg(QString(StageName[i]), source);
+    }
+
+    return parts.join(", ");
+}
+
+bool Pipeline::tempBlocksMatchZones(const PipelineInput& input) const
+{
+    const size_t blocks = m_rawRecords.empty() ? 0 : size_t(std::max(m_rawRecords.back().index, 0));
+    const size_t zones = m_windZones.size();
+
+    // за блоком последней зоны лог может закрываться еще одним блоком
+    if (blocks > zones + 1)
+        return false;
+
+    // лог короче сетки - зонд упал раньше; это допустимо только на
+    // стандартной сетке, по которой пишется лог температуры
+    return blocks >= zones || input.zoneGrid.isStandard();
+}
+
+bool Pipeline::computeWindParse(const PipelineInput& input)
+{
+    FileParser parser;
+
+    m_coordinates.clear();
+    m_coordinates.reserve(10000);
+
+    m_firstZone = Zone(0.0);
+    m_firstMtd = Mtd(4.0);
+
+    RadarSamples samples;
+    samples.reserve(10000);
+
+    m_windDiagnostics.clear();
+    if (input.validate)
+        parser.setDiagnostics(&m_windDiagnostics);
+
+    if (!parser.parseRadarCSV(input.windLogPath, samples, m_firstZone, m_firstMtd))
+        return false;
+
+    // время в логе - в десятых долях секунды
+    RadarSmoother smoother(input.smoothWindow * 10.0);
+    if (!smoother.apply(samples))
+        qDebug() << "Время в логе ветра не возрастает, сглаживание пропущено";
+
+    computeCoordinates(samples, m_coordinates, input.site, input.geopotential);
+    return true;
+}
+
+void Pipeline::computeWindCalc(const PipelineInput& input)
+{
+    Analyzer analyzer;
+
+    m_windZones.clear();
+    m_windMtd.clear();
+    m_windMts.clear();
+
+    // нулевая зона из лога и зоны сетки
+    m_windZones.reserve(1 + input.zoneGrid.count());
+
+    //заполнение МТД
+    for (double h : input.mtdLevels)
+        m_windMtd.emplace_back(h);
+
+    //заполнение МТС
+    for (double h : input.mtsLevels)
+        m_windMts.emplace_back(h);
+
+    m_windZones.push_back(m_firstZone);
+
+    // Обновляем первый уровень МДТ (вместо добавления нового)
+    if (!m_windMtd.empty())
+        m_windMtd[0] = m_firstMtd;
+    else
+        m_windMtd.push_back(m_firstMtd);
+
+    analyzer.createZones(m_windZones, m_coordinates, input.zoneGrid);
+    analyzer.calculateGeopotential(m_windZones, *GeopotentialProfile::forSite(input.site));
+
+    if (input.windLeastSquares)
+        analyzer.calculateVkLsq(m_windZones, m_coordinates);
+    else
+        analyzer.calculateVk(m_windZones);
+    analyzer.calculateVi(m_windZones, m_windMtd);
+    analyzer.calculateV(m_windMtd);
+    analyzer.calculateDHmtd(m_windMtd);
+    analyzer.calculateDHmts(m_windMts);
+    analyzer.calculateVm(m_windZones, m_windMts);
+    analyzer.calculateWm(m_windMts);
+
+    analyzer.createBullutin(m_windMtd);
+    analyzer.createBullutinMts(m_windMts);
+}
+
+bool Pipeline::computeTempParse(const PipelineInput& input)
+{
+    FileParser parser;
+
+    m_rawRecords.clear();
+
+    m_tempDiagnostics.clear();
+    if (input.validate)
+        parser.setDiagnostics(&m_tempDiagnostics);
+
+    return parser.parseTemperatureCSV(input.tempLogPath, m_rawRecords);
+}
+
+void Pipeline::computeTemperature(const PipelineInput& input)
+{
+    Analyzer analyzer;
+
+    // температурная ветвь дописывает поля в копии результатов ветра
+    m_zones = m_windZones;
+    m_mtd = m_windMtd;
+    m_mts = m_windMts;
+    m_records = m_rawRecords;
+
+    const UserConstants& globalParam = input.constants;
+
+    // 0. Считаем толщину зоны
+    analyzer.calculateDeltaH(m_zones);
+
+    // 1. Считаем температуру для каждого измерения
+    analyzer.calculateT(m_records, globalParam);
+
+    // 2. Радиационная поправка по таблице (иначе - из лога) и ее прибавление
+    if (input.radiationTable)
+        analyzer.calculateRadiation(m_records, m_zones, *input.radiationTable, input.sunElevation);
+
+    analyzer.addRadio(m_records);
+
+    // 3. Температура для каждой зоны
+    analyzer.calculateTn(m_records, m_zones);
+
+    // 4. Вычисляем среднюю высоту зоны
+    analyzer.calculateMediumHeight(m_zones);
+
+    // 5. Вычисляем виртуальную поправку для каждой зоны
+    analyzer.calculateDTvir(m_zones, VirtualCorrection(globalParam));
+
+    // 6. Прибавляем виртуальную поправку к температурам зон
+    analyzer.addVir(m_zones);
+
+    // 7. Вычисляем табличное значение температуры для средних высот зон
+    analyzer.fillTabTemperature(input.temperatureTable, m_zones);
+
+    // 1. Расчет табличной плотности для каждой зоны
+    analyzer.fillTabDensity(input.densityTable, m_zones);
+
+    computeAfterTn(globalParam);
+}
+
+// часть температурной ветви, зависящая от констант, но не от таблиц
+void Pipeline::computeAfterTn(const UserConstants& globalParam, size_t pressureFrom)
+{
+    Analyzer analyzer;
+
+    // 8. Вычитаем табличное значение, получаем TTi
+    analyzer.calculateTTi(m_zones);
+
+    // 9. Вычисляем TTcpm для зон
+    analyzer.calculateTTcpm(m_zones);
+
+    // 10. Интерполяция, получаем значения для "метеодействительного"
+    analyzer.interpolateTemperatureToBullutin(m_zones, m_mtd);
+    analyzer.interpolateTemperatureToBullutin(m_zones, m_mts);
+
+    // Давление и плотность
+    // 2. Расчет давления в зоне
+    analyzer.integratePressure(m_zones, globalParam.P0, pressureFrom);
+    // плотность и вертикальная устойчивость зон
+    analyzer.calculateDensityAndStability(m_zones);
+    analyzer.calculatePPcpm(m_zones);
+
+    // Интерполяция плотности, получаем значения для "метеодействительного"
+    analyzer.interpolateDensityToBullutin(m_zones, m_mtd);
+    analyzer.interpolateDensityToBullutin(m_zones, m_mts);
+}
+
+const ZoneSamples& Pipeline::zoneSamples()
+{
+    // группировка зависит от лога температуры, зон и радиационных поправок
+    const QByteArray samplesKey = m_keys[TempParse] + m_keys[WindCalc] + m_radiationKey;
+    if (m_samplesKey != samplesKey)
+    {
+        Analyzer analyzer;
+        analyzer.groupSamples(m_records, m_zones.size(), m_samples);
+        m_samplesKey = samplesKey;
+    }
+
+    return m_samples;
+}
+
+bool Pipeline::updateConstants(const UserConstants& constants)
+{
+    // ключ Temperature здесь не годится: он сбрасывается после каждого
+    // живого пересчета
+    if (!m_temperatureValid || m_zones.empty())
+        return false;
+
+    Analyzer analyzer;
+
+    std::vector<double> oldTvrn(m_zones.size());
+    for (size_t i = 0; i < m_zones.size(); ++i)
+        oldTvrn[i] = m_zones[i].Tvrn;
+
+    // 1-3. Температура зон по сгруппированным Yt
+    analyzer.calculateTnFast(zoneSamples(), constants, m_zones);
+
+    // 5. Виртуальная поправка
+    analyzer.calculateDTvir(m_zones, VirtualCorrection(constants));
+
+    // 6. Прибавляем виртуальную поправку к температурам зон
+    analyzer.addVir(m_zones);
+
+    // давление ниже первой зоны с изменившейся температурой не меняется
+    size_t pressureFrom = 0;
+    if (m_zones[0].Pn == constants.P0)
+    {
+        pressureFrom = 1;
+        while (pressureFrom < m_zones.size() && m_zones[pressureFrom].Tvrn == oldTvrn[pressureFrom])
+            ++pressureFrom;
+    }
+
+    computeAfterTn(constants, pressureFrom);
+
+    // результаты больше не соответствуют ключу этапа: следующий полный
+    // запуск возьмет этап из кэша или пересчитает его; записи не обновлялись
+    m_keys[Temperature].clear();
+    m_source[Temperature] = Computed;
+
+    return true;
+}
+
+// дисковый кэш
+
+QString Pipeline::cacheFile(Stage stage, const QByteArray& key) const
+{
+    return QDir(m_cacheDir).filePath(QString("%1-%2.bin")
+                                         .arg(QString(StageName[stage]))
+                                         .arg(QString::fromLatin1(key.toHex())));
+}
+
+bool Pipeline::loadCached(Stage stage, const QByteArray& key)
+{
+    if (m_cacheDir.isEmpty())
+        return false;
+
+    QFile file(cacheFile(stage, key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    return unpackStage(stage, file.readAll());
+}
+
+void Pipeline::storeCached(Stage stage, const QByteArray& key) const
+{
+    if (m_cacheDir.isEmpty() || !QDir().mkpath(m_cacheDir))
+        return;
+
+    QSaveFile file(cacheFile(stage, key));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(packStage(stage));
+
+    if (!file.commit())
+        qDebug() << "Не удалось записать кэш этапа" << StageName[stage];
+}
+
+void Pipeline::pruneCache() const
+{
+    if (m_cacheDir.isEmpty())
+        return;
+
+    // самые старые файлы удаляем, оставляя CacheLimit последних
+    const QFileInfoList files = QDir(m_cacheDir).entryInfoList(
+        QStringList() << "*.bin", QDir::Files, QDir::Time);
+
+    for (qsizetype i = CacheLimit; i < files.size(); ++i)
+        QFile::remove(files[i].absoluteFilePath());
+}
+
+QByteArray Pipeline::packStage(Stage stage) const
+{
+    QByteArray blob;
+    QDataStream out(&blob, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+
+    switch (stage)
+    {
+    case WindParse:
+        writeVector(out, m_coordinates);
+        writeVector(out, std::vector<Zone>{m_firstZone});
+        writeVector(out, std::vector<Mtd>{m_firstMtd});
+        m_windDiagnostics.write(out);
+        break;
+    case WindCalc:
+        writeVector(out, m_windZones);
+        writeVector(out, m_windMtd);
+        writeVector(out, m_windMts);
+        break;
+    case TempParse:
+        writeRecords(out, m_rawRecords);
+        m_tempDiagnostics.write(out);
+        break;
+    case Temperature:
+        writeVector(out, m_zones);
+        writeVector(out, m_mtd);
+        writeVector(out, m_mts);
+        writeRecords(out, m_records);
+        break;
+    default:
+        break;
+    }
+
+    return blob;
+}
+
+bool Pipeline::unpackStage(Stage stage, const QByteArray& blob)
+{
+    QDataStream in(blob);
+    in.setVersion(StreamVersion);
+
+    switch (stage)
+    {
+    case WindParse:
+    {
+        std::vector<Zone> firstZone;
+        std::vector<Mtd> firstMtd;
+
+        if (!readVector(in, m_coordinates) || !readVector(in, firstZone) || !readVector(in, firstMtd))
+            return false;
+
+        if (firstZone.size() != 1 || firstMtd.size() != 1)
+            return false;
+
+        m_firstZone = firstZone.front();
+        m_firstMtd = firstMtd.front();
+        return m_windDiagnostics.read(in);
+    }
+    case WindCalc:
+        return readVector(in, m_windZones) && readVector(in, m_windMtd) && readVector(in, m_windMts);
+    case TempParse:
+        return readRecords(in, m_rawRecords) && m_tempDiagnostics.read(in);
+    case Temperature:
+        return readVector(in, m_zones) && readVector(in, m_mtd)
+               && readVector(in, m_mts) && readRecords(in, m_records);
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,173 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <QString>
+#include <QByteArray>
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "types.h"
+#include "analyzer.h"
+#include "zonegrid.h"
+#include "radarsamples.h"
+#include "radiationtable.h"
+#include "parsediagnostics.h"
+
+// Исходные данные одного расчета
+struct PipelineInput {
+    QString windLogPath;
+    QString tempLogPath;
+
+    UserConstants constants{};
+
+    std::vector<double> mtdLevels;  // уровни "метеодействительного"
+    std::vector<double> mtsLevels;  // уровни "метеосреднего"
+
+    ZoneGrid zoneGrid = ZoneGrid::standard();
+    bool windLeastSquares = false;  // ветер зоны по МНК по всем отсчетам
+
+    double smoothWindow = 0.0;      // окно сглаживания РЛС, с (0 - без сглаживания)
+    Geopotential geopotential = Geopotential::Corrected;
+    SiteConfig site;                // широта и высота места (профиль силы тяжести)
+
+    std::map<double, double> temperatureTable;
+    std::map<double, double> densityTable;
+
+    // таблица радиационных поправок; нет - поправка из третьего столбца лога
+    std::shared_ptr<const RadiationTable> radiationTable;
+    double sunElevation = 0.0;      // высота солнца, градусы
+
+    // проверяющий разбор логов: строки с ошибками отбрасываются с замечаниями
+    bool validate = false;
+};
+
+// Цепочка расчета, разбитая на этапы с ключами по содержимому входов.
+//
+//   WindParse  <- байты лога ветра, окно сглаживания, место
+//   WindCalc   <- WindParse, уровни бюллетеней, сетка зон
+//   TempParse  <- байты лога температуры
+//   Temperature<- WindCalc, TempParse, константы, таблицы, радиационные поправки
+//
+// Ключ этапа - хэш от ключей предыдущих этапов и собственных параметров.
+// Этап пересчитывается только при смене ключа; результаты также
+// сохраняются на диск, поэтому после перезапуска расчет не повторяется.
+class Pipeline
+{
+public:
+    enum Stage {
+        WindParse = 0,
+        WindCalc,
+        TempParse,
+        Temperature,
+        StageCount
+    };
+
+    // откуда взят результат этапа на последнем запуске
+    enum Source {
+        Memory,
+        Disk,
+        Computed
+    };
+
+    enum Status {
+        Ok,
+        WindLogError,
+        TempLogError,
+        // блоки лога температуры не соответствуют зонам сетки
+        TempZoneMismatch
+    };
+
+    Status run(const PipelineInput& input);
+
+    // Быстрый пересчет температурной ветви при смене констант
+    // (A, B, C, R1, R2, T0, U0, P0) по сгруппированным измерениям зон.
+    // Разбор логов, ветер и табличные значения не пересчитываются.
+    // Возвращает false, если полного расчета еще не было или последний
+    // завершился ошибкой.
+    bool updateConstants(const UserConstants& constants);
+
+    // измерения температуры, сгруппированные по зонам текущего расчета
+    const ZoneSamples& zoneSamples();
+
+    // пустая строка отключает дисковый кэш
+    void setCacheDir(const QString& dir) { m_cacheDir = dir; }
+
+    // SHA-1 содержимого логов, по которым выполнен последний расчет
+    const QByteArray& windLogHash() const { return m_windLogHash; }
+    const QByteArray& tempLogHash() const { return m_tempLogHash; }
+
+    Source source(Stage stage) const { return m_source[stage]; }
+    QByteArray key(Stage stage) const { return m_keys[stage]; }
+
+    // краткий отчет о том, какие этапы были пересчитаны
+    QString summary() const;
+
+    const std::vector<Coordinate>& coordinates() const { return m_coordinates; }
+    const std::vector<Zone>& zones() const { return m_zones; }
+    const std::vector<Mtd>& mtd() const { return m_mtd; }
+    const std::vector<Mts>& mts() const { return m_mts; }
+    const std::vector<TemperatureRecord>& records() const { return m_records; }
+
+    // замечания разбора логов; пустые, если расчет был без validate
+    const ParseDiagnostics& windDiagnostics() const { return m_windDiagnostics; }
+    const ParseDiagnostics& tempDiagnostics() const { return m_tempDiagnostics; }
+
+private:
+    // блоки лога температуры привязаны к зонам по номеру (блок i + 1 -
+    // зона i), поэтому их число должно подходить к сетке зон
+    bool tempBlocksMatchZones(const PipelineInput& input) const;
+
+    bool computeWindParse(const PipelineInput& input);
+    void computeWindCalc(const PipelineInput& input);
+    bool computeTempParse(const PipelineInput& input);
+    void computeTemperature(const PipelineInput& input);
+    // pressureFrom - первая зона, с которой пересчитывается давление
+    void computeAfterTn(const UserConstants& constants, size_t pressureFrom = 0);
+
+    QString cacheFile(Stage stage, const QByteArray& key) const;
+    bool loadCached(Stage stage, const QByteArray& key);
+    void storeCached(Stage stage, const QByteArray& key) const;
+    void pruneCache() const;
+
+    QByteArray packStage(Stage stage) const;
+    bool unpackStage(Stage stage, const QByteArray& blob);
+
+    QString m_cacheDir;
+
+    std::array<QByteArray, StageCount> m_keys;
+    // последний run() дошел до конца: зоны соответствуют логам и сетке
+    bool m_temperatureValid = false;
+    QByteArray m_windLogHash;
+    QByteArray m_tempLogHash;
+    std::array<Source, StageCount> m_source{};
+
+    // WindParse
+    std::vector<Coordinate> m_coordinates;
+    Zone m_firstZone{};
+    Mtd m_firstMtd{};
+    ParseDiagnostics m_windDiagnostics;
+
+    // WindCalc
+    std::vector<Zone> m_windZones;
+    std::vector<Mtd> m_windMtd;
+    std::vector<Mts> m_windMts;
+
+    // TempParse
+    std::vector<TemperatureRecord> m_rawRecords;
+    ParseDiagnostics m_tempDiagnostics;
+
+    // Temperature
+    std::vector<Zone> m_zones;
+    std::vector<Mtd> m_mtd;
+    std::vector<Mts> m_mts;
+    std::vector<TemperatureRecord> m_records;
+
+    // измерения по зонам для updateConstants
+    ZoneSamples m_samples;
+    QByteArray m_samplesKey;
+    QByteArray m_radiationKey;
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,485 @@
+#include "profilechart.h"
+#include "zonetablemodel.h"
+
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+
+const double MarginLeft = 56;
+const double MarginRight = 8;
+const double MarginTop = 22;
+const double MarginBottom = 22;
+const double PanelGap = 10;
+
+// наименьший видимый диапазон высот, м
+const double MinSpan = 20;
+
+// шаг сетки 1, 2 или 5 * 10^n не меньше raw
+double niceStep(double raw)
+{
+    const double p = std::pow(10.0, std::floor(std::log10(raw)));
+    const double f = raw / p;
+
+    if (f <= 1)
+        return p;
+    if (f <= 2)
+        return 2 * p;
+    if (f <= 5)
+        return 5 * p;
+    return 10 * p;
+}
+
+}
+
+ProfileChart::ProfileChart(QWidget* parent)
+    : QWidget(parent)
+{
+    setMinimumSize(400, 300);
+    setFocusPolicy(Qt::StrongFocus);
+    setCursor(Qt::OpenHandCursor);
+}
+
+void ProfileChart::setTrajectory(const std::vector<Coordinate>& coordinates)
+{
+    const bool hadData = !m_panels.empty();
+
+    if (m_hasTrajectory)
+    {
+        m_panels.erase(m_panels.begin());
+        m_hasTrajectory = false;
+    }
+
+    m_trajectoryLo = INFINITY;
+    m_trajectoryHi = -INFINITY;
+
+    if (!coordinates.empty())
+    {
+        Panel trajectory;
+        trajectory.title = "Траектория, км";
+        trajectory.series = {{"X", QColor(30, 90, 200), {}, {}}, {"Z", QColor(200, 60, 40), {}, {}}};
+        for (Series& s : trajectory.series)
+        {
+            s.height.reserve(coordinates.size());
+            s.value.reserve(coordinates.size());
+        }
+        for (const Coordinate& c : coordinates)
+        {
+            trajectory.series[0].height.push_back(c.H);
+            trajectory.series[0].value.push_back(c.X / 1000);
+            trajectory.series[1].height.push_back(c.H);
+            trajectory.series[1].value.push_back(c.Z / 1000);
+
+            m_trajectoryLo = std::min(m_trajectoryLo, c.H);
+            m_trajectoryHi = std::max(m_trajectoryHi, c.H);
+        }
+
+        m_panels.insert(m_panels.begin(), std::move(trajectory));
+        m_hasTrajectory = true;
+    }
+
+    updateDataRange(hadData);
+}
+
+void ProfileChart::setZones(const std::vector<Zone>& zones)
+{
+    const bool hadData = !m_panels.empty();
+
+    // панели зон - все, кроме траектории
+    m_panels.erase(m_panels.begin() + (m_hasTrajectory ? 1 : 0), m_panels.end());
+
+    if (!zones.empty())
+    {
+        // значения зон - на средней высоте зоны
+        Panel wind;
+        wind.title = "Ветер, м/с";
+        wind.series = {{"vx", QColor(30, 90, 200), {}, {}}, {"vz", QColor(200, 60, 40), {}, {}}};
+
+        Panel tti;
+        tti.title = "TTi, °C";
+        tti.series = {{"TTi", QColor(200, 110, 0), {}, {}}};
+
+        Panel ppi;
+        ppi.title = "PPi, %";
+        ppi.series = {{"PPi", QColor(0, 130, 90), {}, {}}};
+
+        // Ri - между серединами соседних зон
+        Panel ri;
+        ri.title = "Ri";
+        ri.series = {{"Ri", QColor(120, 60, 170), {}, {}}};
+        ri.fixedRange = true;
+        ri.lo = -1;
+        ri.hi = 2;
+        ri.mark = ZoneTableModel::CriticalRi;
+
+        for (size_t i = 0; i < zones.size(); ++i)
+        {
+            const Zone& zone = zones[i];
+
+            wind.series[0].height.push_back(zone.Hi);
+            wind.series[0].value.push_back(zone.vx);
+            wind.series[1].height.push_back(zone.Hi);
+            wind.series[1].value.push_back(zone.vz);
+
+            tti.series[0].height.push_back(zone.Hi);
+            tti.series[0].value.push_back(zone.TTi);
+
+            ppi.series[0].height.push_back(zone.Hi);
+            ppi.series[0].value.push_back(zone.PPi);
+
+            if (i > 0)
+            {
+                ri.series[0].height.push_back((zones[i - 1].Hi + zone.Hi) / 2);
+                ri.series[0].value.push_back(zone.Ri);
+            }
+        }
+
+        m_panels.push_back(std::move(wind));
+        m_panels.push_back(std::move(tti));
+        m_panels.push_back(std::move(ppi));
+        m_panels.push_back(std::move(ri));
+    }
+
+    updateDataRange(hadData);
+}
+
+void ProfileChart::updateDataRange(bool hadData)
+{
+    double lo = m_trajectoryLo;
+    double hi = m_trajectoryHi;
+    for (size_t i = m_hasTrajectory ? 1 : 0; i < m_panels.size(); ++i)
+    {
+        for (const Series& s : m_panels[i].series)
+        {
+            for (double h : s.height)
+            {
+                lo = std::min(lo, h);
+                hi = std::max(hi, h);
+            }
+        }
+    }
+
+    if (!(lo < hi))
+    {
+        lo = 0;
+        hi = 1;
+    }
+
+    const bool keepView = hadData && !m_panels.empty() && m_viewLo < hi && m_viewHi > lo;
+
+    m_dataLo = lo;
+    m_dataHi = std::max(hi, lo + MinSpan);
+
+    if (keepView)
+        setViewRange(m_viewLo, m_viewHi);
+    else
+        resetView();
+}
+
+void ProfileChart::resetView()
+{
+    m_viewLo = m_dataLo;
+    m_viewHi = m_dataHi;
+    update();
+}
+
+void ProfileChart::setViewRange(double lo, double hi)
+{
+    const double span = std::clamp(hi - lo, MinSpan, m_dataHi - m_dataLo);
+
+    lo = std::clamp(lo, m_dataLo, m_dataHi - span);
+
+    m_viewLo = lo;
+    m_viewHi = lo + span;
+    update();
+}
+
+QRectF ProfileChart::panelRect(int index) const
+{
+    const int n = std::max<int>(1, int(m_panels.size()));
+    const double width = (this->width() - MarginLeft - MarginRight - PanelGap * (n - 1)) / n;
+
+    return QRectF(MarginLeft + index * (width + PanelGap), MarginTop,
+                  std::max(1.0, width), std::max(1.0, height() - MarginTop - MarginBottom));
+}
+
+double ProfileChart::heightToY(double h, const QRectF& area) const
+{
+    return area.bottom() - (h - m_viewLo) / (m_viewHi - m_viewLo) * area.height();
+}
+
+double ProfileChart::yToHeight(double y, const QRectF& area) const
+{
+    return m_viewLo + (area.bottom() - y) / area.height() * (m_viewHi - m_viewLo);
+}
+
+QPolygonF ProfileChart::decimate(const Series& series, const QRectF& area) const
+{
+    const size_t n = series.height.size();
+    auto visible = [&](size_t i) {
+        return series.height[i] >= m_viewLo && series.height[i] <= m_viewHi;
+    };
+
+    // минимум и максимум строки пикселей; строки выше и ниже панели
+    // (соседи видимых точек) собираются в две крайние корзины
+    struct Bucket {
+        QPointF minPoint, maxPoint;
+        size_t minIndex = 0, maxIndex = 0;
+        bool used = false;
+    };
+
+    const int top = int(std::floor(area.top()));
+    const int rows = int(std::ceil(area.bottom())) - top + 1;
+    std::vector<Bucket> buckets(size_t(rows) + 2);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double v = series.value[i];
+        if (!std::isfinite(v))
+            continue;
+
+        if (!visible(i) && !(i > 0 && visible(i - 1)) && !(i + 1 < n && visible(i + 1)))
+            continue;
+
+        const double y = heightToY(series.height[i], area);
+        const int r = std::clamp(int(std::floor(y)) - top, -1, rows);
+        const QPointF p(v, y);
+
+        Bucket& b = buckets[size_t(r + 1)];
+        if (!b.used)
+        {
+            b.minPoint = b.maxPoint = p;
+            b.minIndex = b.maxIndex = i;
+            b.used = true;
+            continue;
+        }
+
+        if (v < b.minPoint.x())
+        {
+            b.minPoint = p;
+            b.minIndex = i;
+        }
+        if (v > b.maxPoint.x())
+        {
+            b.maxPoint = p;
+            b.maxIndex = i;
+        }
+    }
+
+    // строки снизу вверх (по возрастанию высоты), внутри строки - в порядке
+    // отсчетов: не больше двух точек на строку, даже если шумная высота
+    // много раз переходит границу строки
+    QPolygonF out;
+    for (auto b = buckets.rbegin(); b != buckets.rend(); ++b)
+    {
+        if (!b->used)
+            continue;
+
+        if (b->minIndex == b->maxIndex)
+            out << b->minPoint;
+        else if (b->minIndex < b->maxIndex)
+            out << b->minPoint << b->maxPoint;
+        else
+            out << b->maxPoint << b->minPoint;
+    }
+
+    return out;
+}
+
+void ProfileChart::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+
+    if (m_panels.empty())
+    {
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(rect(), Qt::AlignCenter, "Нет данных расчета");
+        return;
+    }
+
+    const QColor text = palette().color(QPalette::Text);
+    const QColor grid(220, 220, 220);
+
+    // сетка высот, общая для всех панелей
+    const double step = niceStep((m_viewHi - m_viewLo) / 8);
+    const bool km = step >= 100;
+    const int decimals = step >= 1000 ? 0 : (km ? 1 : 0);
+
+    const QRectF first = panelRect(0);
+    for (double h = std::ceil(m_viewLo / step) * step; h <= m_viewHi; h += step)
+    {
+        const double y = heightToY(h, first);
+        painter.setPen(text);
+        painter.drawText(QRectF(0, y - 8, MarginLeft - 6, 16), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(km ? h / 1000 : h, 'f', decimals));
+    }
+    painter.drawText(QRectF(0, 0, MarginLeft - 6, MarginTop), Qt::AlignRight | Qt::AlignVCenter,
+                     km ? "H, км" : "H, м");
+
+    for (size_t p = 0; p < m_panels.size(); ++p)
+    {
+        const Panel& panel = m_panels[p];
+        const QRectF area = panelRect(int(p));
+
+        painter.setPen(grid);
+        for (double h = std::ceil(m_viewLo / step) * step; h <= m_viewHi; h += step)
+        {
+            const double y = heightToY(h, area);
+            painter.drawLine(QPointF(area.left(), y), QPointF(area.right(), y));
+        }
+
+        // прореженные серии: x - значение, y - уже в пикселях
+        std::vector<QPolygonF> lines;
+        double lo = panel.lo;
+        double hi = panel.hi;
+        if (!panel.fixedRange)
+        {
+            lo = INFINITY;
+            hi = -INFINITY;
+        }
+
+        for (const Series& s : panel.series)
+        {
+            lines.push_back(decimate(s, area));
+            if (panel.fixedRange)
+                continue;
+
+            for (const QPointF& point : lines.back())
+            {
+                lo = std::min(lo, point.x());
+                hi = std::max(hi, point.x());
+            }
+        }
+
+        if (!(lo < hi))
+        {
+            const double mid = std::isfinite(lo) ? lo : 0;
+            lo = mid - 1;
+            hi = mid + 1;
+        }
+        else if (!panel.fixedRange)
+        {
+            const double pad = (hi - lo) * 0.05;
+            lo -= pad;
+            hi += pad;
+        }
+
+        auto valueToX = [&](double v) {
+            return area.left() + (v - lo) / (hi - lo) * area.width();
+        };
+
+        painter.save();
+        painter.setClipRect(area);
+
+        if (lo < 0 && hi > 0)
+        {
+            painter.setPen(QPen(QColor(170, 170, 170), 1));
+            painter.drawLine(QPointF(valueToX(0), area.top()), QPointF(valueToX(0), area.bottom()));
+        }
+
+        if (std::isfinite(panel.mark))
+        {
+            painter.setPen(QPen(QColor(220, 0, 0), 1, Qt::DashLine));
+            painter.drawLine(QPointF(valueToX(panel.mark), area.top()), QPointF(valueToX(panel.mark), area.bottom()));
+        }
+
+        painter.setRenderHint(QPainter::Antialiasing);
+        for (size_t s = 0; s < lines.size(); ++s)
+        {
+            QPolygonF& line = lines[s];
+            for (QPointF& point : line)
+                point.setX(valueToX(point.x()));
+
+            painter.setPen(QPen(panel.series[s].color, 1.5));
+            painter.drawPolyline(line);
+        }
+        painter.restore();
+
+        painter.setPen(text);
+        painter.drawRect(area);
+
+        // заголовок и подписи серий
+        QFontMetrics metrics = painter.fontMetrics();
+        double x = area.left();
+        painter.drawText(QPointF(x, MarginTop - 6), panel.title);
+        x += metrics.horizontalAdvance(panel.title) + 8;
+        if (panel.series.size() > 1)
+        {
+            for (const Series& s : panel.series)
+            {
+                painter.setPen(s.color);
+                painter.drawText(QPointF(x, MarginTop - 6), s.name);
+                x += metrics.horizontalAdvance(s.name) + 6;
+            }
+        }
+
+        painter.setPen(text);
+        const QRectF bottom(area.left(), area.bottom() + 2, area.width(), MarginBottom - 4);
+        painter.drawText(bottom, Qt::AlignLeft | Qt::AlignVCenter, QString::number(lo, 'g', 3));
+        painter.drawText(bottom, Qt::AlignRight | Qt::AlignVCenter, QString::number(hi, 'g', 3));
+    }
+}
+
+void ProfileChart::wheelEvent(QWheelEvent* event)
+{
+    if (m_panels.empty())
+        return;
+
+    const double h = std::clamp(yToHeight(event->position().y(), panelRect(0)), m_viewLo, m_viewHi);
+    const double factor = std::pow(0.85, event->angleDelta().y() / 120.0);
+
+    setViewRange(h - (h - m_viewLo) * factor, h + (m_viewHi - h) * factor);
+    event->accept();
+}
+
+void ProfileChart::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton)
+        return;
+
+    m_dragging = true;
+    m_dragY = event->position().y();
+    setCursor(Qt::ClosedHandCursor);
+}
+
+void ProfileChart::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!m_dragging)
+        return;
+
+    // профиль движется за курсором
+    const double y = event->position().y();
+    const double dh = (y - m_dragY) / panelRect(0).height() * (m_viewHi - m_viewLo);
+    m_dragY = y;
+
+    setViewRange(m_viewLo + dh, m_viewHi + dh);
+}
+
+void ProfileChart::mouseReleaseEvent(QMouseEvent*)
+{
+    m_dragging = false;
+    setCursor(Qt::OpenHandCursor);
+}
+
+void ProfileChart::mouseDoubleClickEvent(QMouseEvent*)
+{
+    resetView();
+}
+
+void ProfileChart::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Home)
+    {
+        resetView();
+        return;
+    }
+
+    QWidget::keyPressEvent(event);
+}
@@ -0,0 +1,99 @@
+#ifndef PROFILECHART_H
+#define PROFILECHART_H
+
+#include <QColor>
+#include <QPolygonF>
+#include <QString>
+#include <QWidget>
+#include <vector>
+
+#include "types.h"
+
+// Профили зондирования по высоте: траектория (сырые отсчеты X, Z), ветер
+// зон, TTi, PPi и Ri - панели рядом с общей вертикальной осью высот.
+//
+// Отсчеты прореживаются при каждой отрисовке: все точки, попавшие в одну
+// строку пикселей по высоте, заменяются своими минимумом и максимумом, а
+// строки рисуются по возрастанию высоты. Число рисуемых точек не больше
+// удвоенной высоты панели (и еще четырех за ее краями) при любом числе
+// отсчетов, в том числе когда шумная высота скачет через границу строки.
+//
+// Колесо - масштаб по высоте вокруг курсора, перетаскивание - сдвиг,
+// двойной щелчок или Home - весь профиль.
+class ProfileChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ProfileChart(QWidget* parent = nullptr);
+
+    // Данные копируются; видимый диапазон высот сохраняется, если он
+    // пересекается с новым профилем. Траектория (сотни тысяч отсчетов)
+    // задается отдельно от зон: при живом пересчете меняются только зоны,
+    // и копировать отсчеты заново не нужно.
+    void setTrajectory(const std::vector<Coordinate>& coordinates);
+    void setZones(const std::vector<Zone>& zones);
+
+    // весь диапазон высот
+    void resetView();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+
+private:
+    struct Series {
+        QString name;
+        QColor color;
+        std::vector<double> height;
+        std::vector<double> value;
+    };
+
+    struct Panel {
+        QString title;
+        std::vector<Series> series;
+        // фиксированный диапазон значений (Ri); иначе - по видимым точкам
+        bool fixedRange = false;
+        double lo = 0;
+        double hi = 0;
+        // вертикальная отметка (критическое Ri), NaN - нет
+        double mark = NAN;
+    };
+
+    // прореживание отсчетов серии в координатах пикселей панели: x - значение,
+    // y - высота; точки вне видимых высот отбрасываются (кроме соседних с
+    // видимыми - чтобы линия доходила до края)
+    QPolygonF decimate(const Series& series, const QRectF& area) const;
+
+    QRectF panelRect(int index) const;
+    double heightToY(double h, const QRectF& area) const;
+    double yToHeight(double y, const QRectF& area) const;
+
+    void setViewRange(double lo, double hi);
+
+    // диапазон высот по всем панелям; hadData - до изменения были данные
+    void updateDataRange(bool hadData);
+
+    // панель траектории, если есть, - первая
+    std::vector<Panel> m_panels;
+    bool m_hasTrajectory = false;
+    // диапазон высот траектории, чтобы не проходить отсчеты при смене зон
+    double m_trajectoryLo = INFINITY;
+    double m_trajectoryHi = -INFINITY;
+
+    // весь профиль и видимая часть по высоте, м
+    double m_dataLo = 0;
+    double m_dataHi = 1;
+    double m_viewLo = 0;
+    double m_viewHi = 1;
+
+    bool m_dragging = false;
+    double m_dragY = 0;
+};
+
+#endif // PROFILECHART_H
@@ -0,0 +1,244 @@
+#include "radarsamples.h"
+
+#include <cmath>
+
+namespace {
+
+// полный круг в делениях угломера
+constexpr double FullCircle = 6000.0;
+
+// Синус и косинус без вызова libm, чтобы цикл пересчета векторизовался.
+// Приведение к [-π/4, π/4] по четвертям и ряды Тейлора до r^13 / r^16:
+// ошибка не больше 3e-14 на рабочем диапазоне углов (0..2π).
+// Округление - прибавлением 1.5 * 2^52 (нельзя собирать с -ffast-math).
+inline void sinCos(double x, double& s, double& c)
+{
+    constexpr double TwoOverPi = 0.63661977236758134308;
+    constexpr double PiOver2Hi = 1.57079632673412561417;
+    constexpr double PiOver2Lo = 6.07710050650619224932e-11;
+    constexpr double Round = 6755399441055744.0;
+
+    const double q = (x * TwoOverPi + Round) - Round;
+    const double r = (x - q * PiOver2Hi) - q * PiOver2Lo;
+    const double r2 = r * r;
+
+    const double ps = r * (1.0 + r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 + r2 * (1.0 / 362880
+                      + r2 * (-1.0 / 39916800 + r2 * (1.0 / 6227020800.0)))))));
+    const double pc = 1.0 + r2 * (-0.5 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 + r2 * (1.0 / 40320
+                      + r2 * (-1.0 / 3628800 + r2 * (1.0 / 479001600 + r2 * (-1.0 / 87178291200.0)))))));
+
+    // номер четверти 0..3
+    const double k = q - 4.0 * (((q - 1.5) * 0.25 + Round) - Round);
+    const bool odd = (k == 1.0) || (k == 3.0);
+
+    const double ss = odd ? pc : ps;
+    const double cc = odd ? ps : pc;
+
+    s = (k >= 2.0) ? -ss : ss;
+    c = (k == 1.0 || k == 2.0) ? -cc : cc;
+}
+
+} // namespace
+
+void RadarSmoother::unwrapAzimuth(std::vector<double>& a)
+{
+    double offset = 0.0;
+
+    for (size_t i = 1; i < a.size(); ++i)
+    {
+        const double prev = a[i - 1];
+        double cur = a[i] + offset;
+
+        // переход через север
+        if (cur - prev > FullCircle / 2)
+            offset -= FullCircle;
+        else if (prev - cur > FullCircle / 2)
+            offset += FullCircle;
+
+        a[i] += offset;
+    }
+}
+
+void RadarSmoother::wrapAzimuth(std::vector<double>& a)
+{
+    for (double& v : a)
+    {
+        v = std::fmod(v, FullCircle);
+        if (v < 0)
+            v += FullCircle;
+    }
+}
+
+bool RadarSmoother::apply(RadarSamples& samples)
+{
+    const size_t n = samples.size();
+
+    if (m_window <= 0 || n < 3)
+        return true;
+
+    const std::vector<double>& t = samples.t;
+
+    for (size_t i = 1; i < n; ++i)
+    {
+        if (t[i] < t[i - 1])
+            return false;
+    }
+
+    // границы окон: оба конца только растут
+    const double half = m_window / 2;
+
+    m_lo.resize(n);
+    m_hi.resize(n);
+
+    size_t lo = 0;
+    size_t hi = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        while (t[lo] < t[i] - half)
+            ++lo;
+        while (hi < n && t[hi] <= t[i] + half)
+            ++hi;
+
+        m_lo[i] = lo;
+        m_hi[i] = hi;
+    }
+
+    // накопленные суммы по времени общие для всех столбцов
+    m_t.resize(n);
+    m_sumT.assign(n + 1, 0.0);
+    m_sumTT.assign(n + 1, 0.0);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        m_t[i] = t[i] - t[0];
+        m_sumT[i + 1] = m_sumT[i] + m_t[i];
+        m_sumTT[i + 1] = m_sumTT[i] + m_t[i] * m_t[i];
+    }
+
+    unwrapAzimuth(samples.a);
+
+    smoothColumn(samples.d);
+    smoothColumn(samples.a);
+    smoothColumn(samples.e);
+
+    wrapAzimuth(samples.a);
+
+    return true;
+}
+
+void RadarSmoother::smoothColumn(std::vector<double>& y)
+{
+    const size_t n = y.size();
+
+    m_sumY.assign(n + 1, 0.0);
+    m_sumTY.assign(n + 1, 0.0);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        m_sumY[i + 1] = m_sumY[i] + y[i];
+        m_sumTY[i + 1] = m_sumTY[i] + m_t[i] * y[i];
+    }
+
+    // значение прямой МНК по окну в точке t[i]
+    const size_t* lo = m_lo.data();
+    const size_t* hi = m_hi.data();
+    const double* tt = m_t.data();
+    const double* sT = m_sumT.data();
+    const double* sTT = m_sumTT.data();
+    const double* sY = m_sumY.data();
+    const double* sTY = m_sumTY.data();
+    double* out = y.data();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double k = double(hi[i] - lo[i]);
+        const double st = sT[hi[i]] - sT[lo[i]];
+        const double stt = sTT[hi[i]] - sTT[lo[i]];
+        const double sy = sY[hi[i]] - sY[lo[i]];
+        const double sty = sTY[hi[i]] - sTY[lo[i]];
+
+        const double denom = k * stt - st * st;
+
+        // в окне один момент времени - берем среднее
+        const double b = (std::abs(denom) > EPS * k * k) ? (k * sty - st * sy) / denom : 0.0;
+        const double a = (sy - b * st) / k;
+
+        out[i] = a + b * tt[i];
+    }
+}
+
+void computeGeometry(const RadarSamples& samples, RadarGeometry& geometry,
+                     const SiteConfig& site, Geopotential mode)
+{
+    const size_t n = samples.size();
+
+    geometry.x.resize(n);
+    geometry.z.resize(n);
+    geometry.h.resize(n);
+    geometry.hgeo.resize(n);
+
+    const double* d = samples.d.data();
+    const double* a = samples.a.data();
+    const double* e = samples.e.data();
+
+    double* x = geometry.x.data();
+    double* z = geometry.z.data();
+    double* h = geometry.h.data();
+    double* hgeo = geometry.hgeo.data();
+
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+    {
+        double sinE, cosE, sinA, cosA;
+        sinCos(e[i] * KDU, sinE, cosE);
+        sinCos(a[i] * KDU, sinA, cosA);
+
+        const double horizontal = d[i] * cosE;
+
+        x[i] = horizontal * cosA;
+        z[i] = horizontal * sinA;
+        h[i] = d[i] * sinE + 0.6868e-7 * horizontal * horizontal;
+    }
+
+    if (mode == Geopotential::Legacy)
+    {
+        const double k = (g * m_latitude) / gc;
+
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+            hgeo[i] = k * (rzem * h[i]) / (rzem + h[i]);
+    }
+    else
+    {
+        const auto profile = GeopotentialProfile::forSite(site);
+
+        for (size_t i = 0; i < n; ++i)
+            hgeo[i] = profile->geopotential(h[i]);
+    }
+}
+
+void computeCoordinates(const RadarSamples& samples, std::vector<Coordinate>& coordinates,
+                        const SiteConfig& site, Geopotential mode)
+{
+    RadarGeometry geometry;
+    computeGeometry(samples, geometry, site, mode);
+
+    const size_t n = samples.size();
+    coordinates.reserve(coordinates.size() + n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        Coordinate coord;
+        coord.X = geometry.x[i];
+        coord.Z = geometry.z[i];
+        coord.H = geometry.h[i];
+        coord.S = samples.t[i];
+        coord.H_geo = geometry.hgeo[i];
+
+        coord.dglob = samples.d[i];
+        coord.aglob = samples.a[i];
+        coord.eglob = samples.e[i];
+
+        coordinates.push_back(coord);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef RADARSAMPLES_H
+#define RADARSAMPLES_H
+
+#include <vector>
+
+#include "types.h"
+#include "siteconfig.h"
+
+// Отсчеты лога ветра по столбцам: дальность, азимут и угол места
+// (деления угломера) и время (0.1 с).
+struct RadarSamples {
+    std::vector<double> d;
+    std::vector<double> a;
+    std::vector<double> e;
+    std::vector<double> t;
+
+    size_t size() const { return t.size(); }
+
+    void reserve(size_t n)
+    {
+        d.reserve(n);
+        a.reserve(n);
+        e.reserve(n);
+        t.reserve(n);
+    }
+
+    void clear()
+    {
+        d.clear();
+        a.clear();
+        e.clear();
+        t.clear();
+    }
+
+    void push_back(double dglob, double aglob, double eglob, double tglob)
+    {
+        d.push_back(dglob);
+        a.push_back(aglob);
+        e.push_back(eglob);
+        t.push_back(tglob);
+    }
+};
+
+// Сглаживание отсчетов РЛС скользящей прямой по методу наименьших квадратов.
+//
+// Для каждого отсчета по соседям в окне [t - w/2, t + w/2] строится прямая
+// y = a + b*t и берется ее значение в точке t. Суммы по окну берутся как
+// разности накопленных сумм, поэтому стоимость не зависит от ширины окна.
+// Азимут перед сглаживанием разворачивается через 0/6000.
+class RadarSmoother
+{
+public:
+    // window - ширина окна в единицах времени лога (0.1 с); 0 - без сглаживания
+    explicit RadarSmoother(double window) : m_window(window) {}
+
+    // false - время не возрастает, отсчеты оставлены как есть
+    bool apply(RadarSamples& samples);
+
+    static void unwrapAzimuth(std::vector<double>& a);
+    static void wrapAzimuth(std::vector<double>& a);
+
+private:
+    void smoothColumn(std::vector<double>& y);
+
+    double m_window;
+
+    // границы окна каждого отсчета [lo, hi)
+    std::vector<size_t> m_lo;
+    std::vector<size_t> m_hi;
+
+    // время относительно первого отсчета и накопленные суммы
+    std::vector<double> m_t;
+    std::vector<double> m_sumT;
+    std::vector<double> m_sumTT;
+    std::vector<double> m_sumY;
+    std::vector<double> m_sumTY;
+};
+
+// Геопотенциальная высота:
+//   Legacy    - прежняя формула (g * широта в градусах / gc), для сверки со старыми расчетами;
+//   Corrected - по профилю геопотенциала места (GeopotentialProfile).
+enum class Geopotential {
+    Legacy,
+    Corrected
+};
+
+// Результат пересчета отсчетов по столбцам
+struct RadarGeometry {
+    std::vector<double> x;
+    std::vector<double> z;
+    std::vector<double> h;
+    std::vector<double> hgeo;
+};
+
+// Пакетный пересчет D, A, E -> X, Z, H, геопотенциал. Цикл без ветвлений
+// и вызовов libm (синус и косинус - полиномы), векторизуется компилятором.
+void computeGeometry(const RadarSamples& samples, RadarGeometry& geometry,
+                     const SiteConfig& site = SiteConfig(),
+                     Geopotential mode = Geopotential::Corrected);
+
+// пересчет отсчетов в прямоугольные координаты
+void computeCoordinates(const RadarSamples& samples, std::vector<Coordinate>& coordinates,
+                        const SiteConfig& site = SiteConfig(),
+                        Geopotential mode = Geopotential::Corrected);
+
+#endif // RADARSAMPLES_H
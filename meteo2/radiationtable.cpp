@@ -0,0 +1,187 @@
+#include "radiationtable.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+bool parseRow(const QStringList& items, std::vector<double>& row)
+{
+    row.clear();
+
+    for (const QString& item : items)
+    {
+        bool ok = false;
+        row.push_back(item.trimmed().toDouble(&ok));
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+bool ascending(const std::vector<double>& axis)
+{
+    return std::adjacent_find(axis.begin(), axis.end(), std::greater_equal<double>()) == axis.end();
+}
+
+} // namespace
+
+bool RadiationTable::load(const QString& fileName, QString* error)
+{
+    auto fail = [&](const QString& message)
+    {
+        m_heights.clear();
+        m_elevations.clear();
+        m_values.clear();
+
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return fail("не удалось открыть " + fileName);
+
+    QTextStream in(&file);
+
+    m_heights.clear();
+    m_elevations.clear();
+    m_values.clear();
+
+    std::vector<double> row;
+    int lineNumber = 0;
+
+    while (!in.atEnd())
+    {
+        const QString line = in.readLine().trimmed();
+        ++lineNumber;
+
+        if (line.isEmpty())
+            continue;
+
+        QStringList items = line.split(',');
+
+        // заголовок: подпись и высоты солнца
+        if (m_elevations.empty())
+        {
+            items.removeFirst();
+            if (items.isEmpty() || !parseRow(items, m_elevations) || !ascending(m_elevations))
+                return fail(QString("строка %1: высоты солнца должны возрастать").arg(lineNumber));
+            continue;
+        }
+
+        if (!parseRow(items, row) || row.size() != m_elevations.size() + 1)
+            return fail(QString("строка %1: ожидается высота и %2 значений")
+                            .arg(lineNumber).arg(int(m_elevations.size())));
+
+        m_heights.push_back(row.front());
+        m_values.insert(m_values.end(), row.begin() + 1, row.end());
+    }
+
+    if (m_heights.empty())
+        return fail("таблица пуста");
+
+    if (!ascending(m_heights))
+        return fail("высоты должны возрастать");
+
+    return true;
+}
+
+void RadiationTable::locate(const std::vector<double>& axis, double x, size_t& i, double& w)
+{
+    // NaN - тоже к нижнему краю
+    if (axis.size() < 2 || !(x > axis.front()))
+    {
+        i = 0;
+        w = 0.0;
+        return;
+    }
+
+    if (x >= axis.back())
+    {
+        i = axis.size() - 2;
+        w = 1.0;
+        return;
+    }
+
+    i = size_t(std::upper_bound(axis.begin(), axis.end(), x) - axis.begin()) - 1;
+    w = (x - axis[i]) / (axis[i + 1] - axis[i]);
+}
+
+double RadiationTable::value(double height, double elevation) const
+{
+    double out = 0.0;
+    apply(&height, &elevation, &out, 1);
+    return out;
+}
+
+void RadiationTable::apply(const double* heights, const double* elevations, double* out, size_t n) const
+{
+    if (isEmpty())
+    {
+        std::fill(out, out + n, 0.0);
+        return;
+    }
+
+    const size_t cols = m_elevations.size();
+
+    // соседний узел по оси из одного значения - тот же узел
+    const size_t nextRow = (m_heights.size() > 1) ? cols : 0;
+    const size_t nextCol = (cols > 1) ? 1 : 0;
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        size_t i, j;
+        double u, v;
+        locate(m_heights, heights[k], i, u);
+        locate(m_elevations, elevations[k], j, v);
+
+        const double* p = m_values.data() + i * cols + j;
+
+        const double lower = p[0] + (p[nextCol] - p[0]) * v;
+        const double upper = p[nextRow] + (p[nextRow + nextCol] - p[nextRow]) * v;
+
+        out[k] = lower + (upper - lower) * u;
+    }
+}
+
+void RadiationTable::profile(double elevation, const double* heights, double* out, size_t n) const
+{
+    if (isEmpty())
+    {
+        std::fill(out, out + n, 0.0);
+        return;
+    }
+
+    const size_t rows = m_heights.size();
+    const size_t cols = m_elevations.size();
+
+    size_t j;
+    double v;
+    locate(m_elevations, elevation, j, v);
+
+    const size_t nextCol = (cols > 1) ? 1 : 0;
+
+    // столбец для этой высоты солнца
+    std::vector<double> column(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const double* p = m_values.data() + i * cols + j;
+        column[i] = p[0] + (p[nextCol] - p[0]) * v;
+    }
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        size_t i;
+        double u;
+        locate(m_heights, heights[k], i, u);
+
+        out[k] = (rows > 1) ? column[i] + (column[i + 1] - column[i]) * u : column[0];
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef RADIATIONTABLE_H
+#define RADIATIONTABLE_H
+
+#include <QString>
+#include <vector>
+
+// Двухвходовая таблица радиационных поправок ΔTp: высота × высота солнца.
+//
+// Файл - CSV, первая строка - подпись и высоты солнца (градусы),
+// следующие - высота (м) и поправки для каждой высоты солнца:
+//
+//   h\e,0,10,20
+//   0,0.1,0.2,0.3
+//   5000,0.3,0.5,0.8
+//
+// Значения хранятся одним массивом по строкам. Между узлами - билинейная
+// интерполяция, за пределами таблицы - значение ближайшего края.
+class RadiationTable
+{
+public:
+    bool load(const QString& fileName, QString* error = nullptr);
+
+    bool isEmpty() const { return m_values.empty(); }
+
+    const std::vector<double>& heights() const { return m_heights; }
+    const std::vector<double>& elevations() const { return m_elevations; }
+    const std::vector<double>& values() const { return m_values; }
+
+    double value(double height, double elevation) const;
+
+    // поправки для n пар (высота, высота солнца)
+    void apply(const double* heights, const double* elevations, double* out, size_t n) const;
+
+    // поправки для n высот при одной высоте солнца: столбец таблицы
+    // интерполируется один раз, дальше - линейная интерполяция по высоте
+    void profile(double elevation, const double* heights, double* out, size_t n) const;
+
+private:
+    // отрезок оси [i, i + 1] и доля внутри него (с прижатием к краям)
+    static void locate(const std::vector<double>& axis, double x, size_t& i, double& w);
+
+    std::vector<double> m_heights;
+    std::vector<double> m_elevations;
+    std::vector<double> m_values;  // m_heights.size() строк по m_elevations.size()
+};
+
+#endif // RADIATIONTABLE_H
@@ -0,0 +1,393 @@
+#include "resultwriter.h"
+
+#include <QDir>
+#include <QtEndian>
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+namespace {
+
+const char ColumnarMagic[4] = {'M', 'C', 'O', 'L'};
+const quint32 ColumnarVersion = 1;
+
+const char* const SoundingColumn = "sounding";
+
+// строка JSON в кавычках
+QByteArray jsonString(const QByteArray& text)
+{
+    QByteArray out;
+    out.reserve(text.size() + 2);
+    out += '"';
+
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+
+    out += '"';
+    return out;
+}
+
+// поле CSV: в кавычках, если есть запятая, кавычка или перевод строки
+QByteArray csvField(const QByteArray& text)
+{
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n'))
+        return text;
+
+    QByteArray out = text;
+    out.replace("\"", "\"\"");
+    return "\"" + out + "\"";
+}
+
+// разность направлений в больших делениях угломера (0-59) приводится к
+// [-30, 30): 58 против 2 - это -4, а не 56
+double directionDifference(double a, double b)
+{
+    const double d = a - b;
+    return d - 60.0 * std::floor((d + 30.0) / 60.0);
+}
+
+}
+
+bool ResultWriter::parseFormat(const QString& name, Format& format)
+{
+    const QString n = name.trimmed().toLower();
+
+    if (n == "csv")
+        format = Format::Csv;
+    else if (n == "jsonl" || n == "json")
+        format = Format::JsonLines;
+    else if (n == "columnar" || n == "bin")
+        format = Format::Columnar;
+    else
+        return false;
+
+    return true;
+}
+
+const char* ResultWriter::extension(Format format)
+{
+    switch (format)
+    {
+    case Format::Csv:       return "csv";
+    case Format::JsonLines: return "jsonl";
+    case Format::Columnar:  return "mcol";
+    }
+
+    return "";
+}
+
+ResultWriter::ResultWriter(Format format, const char* const* columns, size_t columnCount)
+    : m_format(format)
+{
+    m_columns.reserve(columnCount);
+    for (size_t i = 0; i < columnCount; ++i)
+        m_columns.emplace_back(columns[i]);
+}
+
+bool ResultWriter::open(const QString& fileName)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly))
+        return false;
+
+    m_buffer.clear();
+    m_buffer.reserve(BufferSize + 1024);
+    m_failed = false;
+
+    writeHeader();
+    return true;
+}
+
+void ResultWriter::writeHeader()
+{
+    switch (m_format)
+    {
+    case Format::Csv:
+        m_buffer += SoundingColumn;
+        for (const QByteArray& column : m_columns)
+        {
+            m_buffer += ',';
+            m_buffer += column;
+        }
+        m_buffer += '\n';
+        break;
+
+    case Format::JsonLines:
+        // ключи объектов заранее в виде ,"имя":
+        for (QByteArray& column : m_columns)
+            column = "," + jsonString(column) + ":";
+        break;
+
+    case Format::Columnar:
+        m_buffer.append(ColumnarMagic, sizeof(ColumnarMagic));
+        appendU32(ColumnarVersion);
+        appendU32(quint32(m_columns.size()));
+        for (const QByteArray& column : m_columns)
+        {
+            appendU16(quint16(column.size()));
+            m_buffer += column;
+        }
+        break;
+    }
+}
+
+void ResultWriter::beginGroup(const QByteArray& key, size_t rows)
+{
+    switch (m_format)
+    {
+    case Format::Csv:
+        m_rowPrefix = csvField(key);
+        break;
+
+    case Format::JsonLines:
+        m_rowPrefix = "{\"sounding\":" + jsonString(key);
+        break;
+
+    case Format::Columnar:
+        appendU32(quint32(rows));
+        appendU16(quint16(key.size()));
+        m_buffer += key;
+        break;
+    }
+}
+
+void ResultWriter::beginRow()
+{
+    m_buffer += m_rowPrefix;
+}
+
+void ResultWriter::appendValue(size_t column, double value)
+{
+    if (m_format == Format::Csv)
+        m_buffer += ',';
+    else
+        m_buffer += m_columns[column];
+
+    if (!std::isfinite(value))
+    {
+        if (m_format == Format::JsonLines)
+            m_buffer += "null";
+        return;
+    }
+
+    // не snprintf: QCoreApplication ставит локаль системы, и в ru_RU
+    // получилось бы "1,5" - лишний столбец CSV и неверный JSON
+    m_buffer += QByteArray::number(value, 'g', 10);
+}
+
+void ResultWriter::endRow()
+{
+    if (m_format == Format::JsonLines)
+        m_buffer += '}';
+    m_buffer += '\n';
+
+    flushIfFull();
+}
+
+void ResultWriter::appendBinary(double value)
+{
+    char bytes[sizeof(double)];
+    qToLittleEndian(value, bytes);
+    m_buffer.append(bytes, sizeof(bytes));
+
+    flushIfFull();
+}
+
+void ResultWriter::appendU16(quint16 value)
+{
+    char bytes[sizeof(value)];
+    qToLittleEndian(value, bytes);
+    m_buffer.append(bytes, sizeof(bytes));
+}
+
+void ResultWriter::appendU32(quint32 value)
+{
+    char bytes[sizeof(value)];
+    qToLittleEndian(value, bytes);
+    m_buffer.append(bytes, sizeof(bytes));
+}
+
+void ResultWriter::flushIfFull()
+{
+    if (m_buffer.size() < BufferSize)
+        return;
+
+    if (m_file.write(m_buffer) != m_buffer.size())
+        m_failed = true;
+    m_buffer.clear();
+}
+
+bool ResultWriter::close()
+{
+    if (m_format == Format::Columnar)
+        appendU32(0);
+
+    if (!m_buffer.isEmpty() && m_file.write(m_buffer) != m_buffer.size())
+        m_failed = true;
+    m_buffer.clear();
+
+    if (m_failed)
+    {
+        m_file.cancelWriting();
+        m_file.commit();
+        return false;
+    }
+
+    return m_file.commit();
+}
+
+ResultExport::ResultExport(const QString& dir, const std::vector<ResultWriter::Format>& formats)
+    : m_dir(dir),
+    m_formats(formats)
+{
+}
+
+bool ResultExport::open(QString* error)
+{
+    if (!QDir().mkpath(m_dir))
+    {
+        if (error)
+            *error = "не удалось создать каталог " + m_dir;
+        return false;
+    }
+
+    const QDir dir(m_dir);
+    m_files.clear();
+
+    for (ResultWriter::Format format : m_formats)
+    {
+        Files files;
+        files.zones = ResultWriter::forType<Zone>(format);
+        files.mtd = ResultWriter::forType<Mtd>(format);
+        files.mts = ResultWriter::forType<Mts>(format);
+        files.mtdResiduals = ResultWriter::forType<MtdResidual>(format);
+        files.mtsResiduals = ResultWriter::forType<MtsResidual>(format);
+        files.quality = ResultWriter::forType<SoundingQuality>(format);
+
+        const std::pair<ResultWriter*, const char*> targets[] = {
+            {files.zones.get(), "zones"},
+            {files.mtd.get(), "mtd"},
+            {files.mts.get(), "mts"},
+            {files.mtdResiduals.get(), "mtd_residuals"},
+            {files.mtsResiduals.get(), "mts_residuals"},
+            {files.quality.get(), "quality"},
+        };
+
+        for (const auto& [writer, name] : targets)
+        {
+            const QString fileName = dir.filePath(QString("%1.%2").arg(name, ResultWriter::extension(format)));
+            if (!writer->open(fileName))
+            {
+                if (error)
+                    *error = "не удалось открыть " + fileName;
+                return false;
+            }
+        }
+
+        m_files.push_back(std::move(files));
+    }
+
+    return true;
+}
+
+void ResultExport::writeSounding(const QByteArray& key,
+                                 const std::vector<Zone>& zones,
+                                 const std::vector<Mtd>& mtd,
+                                 const std::vector<Mts>& mts,
+                                 const std::vector<MtdResidual>& mtdResiduals,
+                                 const std::vector<MtsResidual>& mtsResiduals)
+{
+    for (Files& files : m_files)
+    {
+        files.zones->write(key, zones);
+        files.mtd->write(key, mtd);
+        files.mts->write(key, mts);
+        files.mtdResiduals->write(key, mtdResiduals);
+        files.mtsResiduals->write(key, mtsResiduals);
+    }
+}
+
+void ResultExport::writeQuality(const QByteArray& key, const SoundingQuality& quality)
+{
+    const std::vector<SoundingQuality> rows = {quality};
+
+    for (Files& files : m_files)
+        files.quality->write(key, rows);
+}
+
+bool ResultExport::close(QString* error)
+{
+    bool ok = true;
+
+    for (Files& files : m_files)
+    {
+        for (ResultWriter* writer : {files.zones.get(), files.mtd.get(), files.mts.get(),
+                                     files.mtdResiduals.get(), files.mtsResiduals.get(),
+                                     files.quality.get()})
+            ok = writer->close() && ok;
+    }
+
+    m_files.clear();
+
+    if (!ok && error)
+        *error = "не удалось записать выгрузку в " + m_dir;
+
+    return ok;
+}
+
+std::vector<MtdResidual> ResultExport::residuals(const std::vector<Mtd>& mtd, const std::vector<Bull_mtd>& bulletin)
+{
+    std::map<double, const Bull_mtd*> byHeight;
+    for (const Bull_mtd& b : bulletin)
+        byHeight[b.h] = &b;
+
+    std::vector<MtdResidual> out;
+    for (const Mtd& m : mtd)
+    {
+        auto it = byHeight.find(m.h);
+        if (it == byHeight.end())
+            continue;
+
+        const Bull_mtd& b = *it->second;
+        out.push_back({m.h, m.v - b.v, directionDifference(m.av, b.av), m.TTi - b.TTi, m.PPi - b.PPi});
+    }
+
+    return out;
+}
+
+std::vector<MtsResidual> ResultExport::residuals(const std::vector<Mts>& mts, const std::vector<Bull_mts>& bulletin)
+{
+    std::map<double, const Bull_mts*> byHeight;
+    for (const Bull_mts& b : bulletin)
+        byHeight[b.h] = &b;
+
+    std::vector<MtsResidual> out;
+    for (const Mts& m : mts)
+    {
+        auto it = byHeight.find(m.h);
+        if (it == byHeight.end())
+            continue;
+
+        const Bull_mts& b = *it->second;
+        out.push_back({m.h, m.w - b.w, directionDifference(m.aw, b.aw), m.TTcpm - b.TTcpm, m.PPcpm - b.PPcpm});
+    }
+
+    return out;
+}
@@ -0,0 +1,258 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <QByteArray>
+#include <QSaveFile>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "types.h"
+#include "typesio.h"
+
+// Отклонения рассчитанного бюллетеня от бюллетеня метеокомплекса на
+// совпадающих высотах: расчет минус бюллетень. Отклонения направлений
+// (av, aw) приведены к [-30, 30) больших делений угломера.
+struct MtdResidual {
+    double h{};
+    double v{};
+    double av{};
+    double TTi{};
+    double PPi{};
+};
+
+struct MtsResidual {
+    double h{};
+    double w{};
+    double aw{};
+    double TTcpm{};
+    double PPcpm{};
+};
+
+// Качество входных данных зондирования по проверяющему разбору: число
+// строк данных, отброшенных строк и пропущенных групп бюллетеней.
+struct SoundingQuality {
+    double windLines{};
+    double windRejected{};
+    double tempLines{};
+    double tempRejected{};
+    double bulletinRejected{};
+    double bulletinMissing{};
+    // доля принятых строк логов ветра и температуры
+    double accepted{};
+};
+
+template<>
+struct FieldTable<MtdResidual> {
+    static constexpr double MtdResidual::* fields[] = {
+        &MtdResidual::h, &MtdResidual::v, &MtdResidual::av, &MtdResidual::TTi, &MtdResidual::PPi
+    };
+};
+
+template<>
+struct FieldTable<MtsResidual> {
+    static constexpr double MtsResidual::* fields[] = {
+        &MtsResidual::h, &MtsResidual::w, &MtsResidual::aw, &MtsResidual::TTcpm, &MtsResidual::PPcpm
+    };
+};
+
+template<>
+struct FieldTable<SoundingQuality> {
+    static constexpr double SoundingQuality::* fields[] = {
+        &SoundingQuality::windLines, &SoundingQuality::windRejected,
+        &SoundingQuality::tempLines, &SoundingQuality::tempRejected,
+        &SoundingQuality::bulletinRejected, &SoundingQuality::bulletinMissing,
+        &SoundingQuality::accepted
+    };
+};
+
+// Имена столбцов выгрузки - в порядке FieldTable<T>::fields.
+template<typename T>
+struct FieldNames;
+
+template<>
+struct FieldNames<Zone> {
+    static constexpr const char* names[] = {
+        "x", "z", "s", "vx", "vz", "dh", "y",
+        "height", "dH", "Hi", "Tn",
+        "TTi", "TTcpm", "dTvir", "Tvrn", "Ttab",
+        "Pn", "Pi", "Pitab", "PPi", "PPcpm",
+        "Ri", "T",
+        "vxErr", "vzErr", "nSamples",
+        "Hgeo",
+        "Un"
+    };
+};
+
+template<>
+struct FieldNames<Mtd> {
+    static constexpr const char* names[] = {
+        "h", "y_prev", "y_next", "vx", "vz", "v", "av", "dh",
+        "TTi", "TTcpm", "PPi", "PPcpm"
+    };
+};
+
+template<>
+struct FieldNames<Mts> {
+    static constexpr const char* names[] = {
+        "h", "y_prev", "y_next", "vx", "vz",
+        "wx", "wz", "w", "aw", "dh",
+        "TTi", "TTcpm", "PPi", "PPcpm"
+    };
+};
+
+template<>
+struct FieldNames<MtdResidual> {
+    static constexpr const char* names[] = {"h", "dv", "dav", "dTTi", "dPPi"};
+};
+
+template<>
+struct FieldNames<MtsResidual> {
+    static constexpr const char* names[] = {"h", "dw", "daw", "dTTcpm", "dPPcpm"};
+};
+
+template<>
+struct FieldNames<SoundingQuality> {
+    static constexpr const char* names[] = {
+        "windLines", "windRejected", "tempLines", "tempRejected",
+        "bulletinRejected", "bulletinMissing", "accepted"
+    };
+};
+
+// Потоковая запись таблицы результатов многих зондирований в один файл.
+//
+// Первый столбец - имя зондирования (key), дальше - поля структуры T.
+// Значения форматируются в буфер без промежуточных строк и пишутся
+// блоками по BufferSize байт.
+//
+//   Csv       - строка заголовков, числа через запятую, NaN - пустое поле;
+//   JsonLines - объект на строку: {"sounding":"...","h":25,...}, NaN - null;
+//   Columnar  - двоичный столбцовый формат (все числа - little endian):
+//                 "MCOL", u32 версия (1), u32 число столбцов,
+//                 имена столбцов: u16 длина + UTF-8;
+//                 группы строк (одна на зондирование):
+//                   u32 число строк (> 0), u16 длина + имя зондирования,
+//                   столбцы подряд: число строк × f64 на столбец;
+//                 u32 0 - конец файла.
+class ResultWriter
+{
+public:
+    enum class Format {
+        Csv,
+        JsonLines,
+        Columnar
+    };
+
+    static constexpr int BufferSize = 1 << 16;
+
+    // "csv", "jsonl", "columnar"
+    static bool parseFormat(const QString& name, Format& format);
+    static const char* extension(Format format);
+
+    ResultWriter(Format format, const char* const* columns, size_t columnCount);
+
+    template<typename T>
+    static std::unique_ptr<ResultWriter> forType(Format format)
+    {
+        static_assert(std::size(FieldNames<T>::names) == std::size(FieldTable<T>::fields),
+                      "имена столбцов не совпадают с таблицей полей");
+        return std::make_unique<ResultWriter>(format, FieldNames<T>::names, std::size(FieldNames<T>::names));
+    }
+
+    bool open(const QString& fileName);
+
+    // строки одного зондирования
+    template<typename T>
+    void write(const QByteArray& key, const std::vector<T>& rows)
+    {
+        if (rows.empty())
+            return;
+
+        beginGroup(key, rows.size());
+
+        if (m_format == Format::Columnar)
+        {
+            for (auto field : FieldTable<T>::fields)
+                for (const T& row : rows)
+                    appendBinary(row.*field);
+        }
+        else
+        {
+            for (const T& row : rows)
+            {
+                beginRow();
+                for (size_t c = 0; c < std::size(FieldTable<T>::fields); ++c)
+                    appendValue(c, row.*(FieldTable<T>::fields[c]));
+                endRow();
+            }
+        }
+    }
+
+    // дописывает конец файла и сохраняет его
+    bool close();
+
+private:
+    void writeHeader();
+    void beginGroup(const QByteArray& key, size_t rows);
+    void beginRow();
+    void appendValue(size_t column, double value);
+    void endRow();
+
+    void appendBinary(double value);
+    void appendU16(quint16 value);
+    void appendU32(quint32 value);
+
+    void flushIfFull();
+
+    Format m_format;
+    std::vector<QByteArray> m_columns;
+
+    QSaveFile m_file;
+    QByteArray m_buffer;
+    // начало строк текущего зондирования (имя уже в кавычках)
+    QByteArray m_rowPrefix;
+    bool m_failed = false;
+};
+
+// Выгрузка результатов архива: по файлу на таблицу и формат
+// (zones, mtd, mts, mtd_residuals, mts_residuals, quality).
+class ResultExport
+{
+public:
+    ResultExport(const QString& dir, const std::vector<ResultWriter::Format>& formats);
+
+    // false - не удалось создать файлы (причина в error)
+    bool open(QString* error = nullptr);
+
+    void writeSounding(const QByteArray& key,
+                       const std::vector<Zone>& zones,
+                       const std::vector<Mtd>& mtd,
+                       const std::vector<Mts>& mts,
+                       const std::vector<MtdResidual>& mtdResiduals,
+                       const std::vector<MtsResidual>& mtsResiduals);
+
+    // только при проверяющем разборе
+    void writeQuality(const QByteArray& key, const SoundingQuality& quality);
+
+    bool close(QString* error = nullptr);
+
+    // расчет минус бюллетень на высотах, которые есть в обоих
+    static std::vector<MtdResidual> residuals(const std::vector<Mtd>& mtd, const std::vector<Bull_mtd>& bulletin);
+    static std::vector<MtsResidual> residuals(const std::vector<Mts>& mts, const std::vector<Bull_mts>& bulletin);
+
+private:
+    struct Files {
+        std::unique_ptr<ResultWriter> zones;
+        std::unique_ptr<ResultWriter> mtd;
+        std::unique_ptr<ResultWriter> mts;
+        std::unique_ptr<ResultWriter> mtdResiduals;
+        std::unique_ptr<ResultWriter> mtsResiduals;
+        std::unique_ptr<ResultWriter> quality;
+    };
+
+    QString m_dir;
+    std::vector<ResultWriter::Format> m_formats;
+    std::vector<Files> m_files;
+};
+
+#endif // RESULTWRITER_H
@@ -0,0 +1,250 @@
+#include "sessionfile.h"
+#include "typesio.h"
+
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QDebug>
+
+namespace {
+
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+template<typename T>
+QByteArray packVector(const std::vector<T>& items)
+{
+    QByteArray blob;
+    QDataStream out(&blob, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+
+    writeVector(out, items);
+
+    return blob;
+}
+
+template<typename T>
+bool unpackVector(const QByteArray& blob, std::vector<T>& items)
+{
+    QDataStream in(blob);
+    in.setVersion(StreamVersion);
+
+    return readVector(in, items);
+}
+
+QByteArray packMeta(const SessionMeta& meta)
+{
+    QByteArray blob;
+    QDataStream out(&blob, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+
+    out << meta.created.toMSecsSinceEpoch()
+        << meta.windLogPath << meta.tempLogPath
+        << meta.windLogHash << meta.tempLogHash;
+
+    out << quint32(std::size(FieldTable<UserConstants>::fields));
+    writeRecord(out, meta.constants);
+
+    // дописано в конец секции: старые файлы читаются без срока
+    out << (meta.soundingTime.isValid() ? meta.soundingTime.toMSecsSinceEpoch() : qint64(0));
+
+    return blob;
+}
+
+} // namespace
+
+bool SessionFile::save(const QString& fileName,
+                       const SessionMeta& meta,
+                       const std::vector<Coordinate>& coordinates,
+                       const std::vector<Zone>& zones,
+                       const std::vector<Mtd>& mtd,
+                       const std::vector<Mts>& mts,
+                       const std::vector<Bull_mtd>& bull_mtd,
+                       const std::vector<Bull_mts>& bull_mts)
+{
+    // порядок секций: сначала то, что нужно для таблиц, в конце - объемные данные
+    const std::vector<std::pair<Section, QByteArray>> sections = {
+        {Meta,        packMeta(meta)},
+        {MtdTable,    packVector(mtd)},
+        {MtsTable,    packVector(mts)},
+        {BullMtd,     packVector(bull_mtd)},
+        {BullMts,     packVector(bull_mts)},
+        {Zones,       packVector(zones)},
+        {Coordinates, packVector(coordinates)},
+    };
+
+    // заголовок: magic, версия, число секций и оглавление
+    const quint64 headerSize = 3 * sizeof(quint32)
+                               + sections.size() * (sizeof(quint32) + 2 * sizeof(quint64));
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+
+    out << Magic << FormatVersion << quint32(sections.size());
+
+    quint64 offset = headerSize;
+    for (const auto& section : sections)
+    {
+        out << quint32(section.first) << offset << quint64(section.second.size());
+        offset += section.second.size();
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(header);
+    for (const auto& section : sections)
+        file.write(section.second);
+
+    return file.commit();
+}
+
+QByteArray SessionFile::fileHash(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+
+    return hash.result();
+}
+
+bool SessionFile::open(const QString& fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&m_file);
+    in.setVersion(StreamVersion);
+
+    quint32 magic{};
+    quint32 count{};
+    in >> magic >> m_version >> count;
+
+    if (in.status() != QDataStream::Ok || magic != Magic || m_version > FormatVersion)
+    {
+        qDebug() << "Неизвестный формат файла сессии:" << fileName;
+        close();
+        return false;
+    }
+
+    for (quint32 i = 0; i < count; ++i)
+    {
+        quint32 id{};
+        Entry entry;
+        in >> id >> entry.offset >> entry.size;
+
+        if (entry.offset + entry.size > quint64(m_file.size()))
+        {
+            close();
+            return false;
+        }
+
+        m_sections[id] = entry;
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void SessionFile::close()
+{
+    if (m_file.isOpen())
+        m_file.close();
+
+    m_sections.clear();
+    m_version = 0;
+}
+
+bool SessionFile::readSection(Section id, QByteArray& data)
+{
+    auto it = m_sections.find(id);
+    if (it == m_sections.end() || !m_file.isOpen())
+        return false;
+
+    if (!m_file.seek(qint64(it->second.offset)))
+        return false;
+
+    data = m_file.read(qint64(it->second.size));
+
+    return data.size() == qint64(it->second.size);
+}
+
+bool SessionFile::loadMeta(SessionMeta& meta)
+{
+    QByteArray blob;
+    if (!readSection(Meta, blob))
+        return false;
+
+    QDataStream in(blob);
+    in.setVersion(StreamVersion);
+
+    qint64 created{};
+    quint32 storedFields{};
+
+    in >> created
+       >> meta.windLogPath >> meta.tempLogPath
+       >> meta.windLogHash >> meta.tempLogHash
+       >> storedFields;
+
+    meta.created = QDateTime::fromMSecsSinceEpoch(created);
+    readRecord(in, meta.constants, storedFields);
+
+    meta.soundingTime = QDateTime();
+    if (in.status() == QDataStream::Ok && !in.atEnd())
+    {
+        qint64 soundingTime{};
+        in >> soundingTime;
+        if (soundingTime != 0)
+            meta.soundingTime = QDateTime::fromMSecsSinceEpoch(soundingTime);
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+
+bool SessionFile::loadCoordinates(std::vector<Coordinate>& coordinates)
+{
+    QByteArray blob;
+    return readSection(Coordinates, blob) && unpackVector(blob, coordinates);
+}
+
+bool SessionFile::loadZones(std::vector<Zone>& zones)
+{
+    QByteArray blob;
+    return readSection(Zones, blob) && unpackVector(blob, zones);
+}
+
+bool SessionFile::loadMtd(std::vector<Mtd>& mtd)
+{
+    QByteArray blob;
+    return readSection(MtdTable, blob) && unpackVector(blob, mtd);
+}
+
+bool SessionFile::loadMts(std::vector<Mts>& mts)
+{
+    QByteArray blob;
+    return readSection(MtsTable, blob) && unpackVector(blob, mts);
+}
+
+bool SessionFile::loadBullMtd(std::vector<Bull_mtd>& records)
+{
+    QByteArray blob;
+    return readSection(BullMtd, blob) && unpackVector(blob, records);
+}
+
+bool SessionFile::loadBullMts(std::vector<Bull_mts>& records)
+{
+    QByteArray blob;
+    return readSection(BullMts, blob) && unpackVector(blob, records);
+}
@@ -0,0 +1,92 @@
+#ifndef SESSIONFILE_H
+#define SESSIONFILE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <map>
+#include <vector>
+
+#include "types.h"
+
+// Метаданные сохраненного расчета
+struct SessionMeta {
+    QDateTime created;          // время сохранения
+
+    QString windLogPath;        // путь к логу ветра на момент расчета
+    QString tempLogPath;        // путь к логу температуры на момент расчета
+
+    QByteArray windLogHash;     // SHA-1 содержимого лога ветра
+    QByteArray tempLogHash;     // SHA-1 содержимого лога температуры
+
+    UserConstants constants{};  // константы, с которыми выполнен расчет
+
+    QDateTime soundingTime;     // срок зондирования (для бюллетеней)
+};
+
+// Файл сессии: версионированный бинарный формат с оглавлением секций.
+//
+// [magic][version][count] [id, offset, size] * count [секции...]
+//
+// Оглавление читается при открытии, сами секции - по запросу,
+// поэтому для показа таблиц не нужно читать зоны и координаты.
+class SessionFile
+{
+public:
+    enum Section : quint32 {
+        Meta        = 1,
+        Zones       = 2,
+        MtdTable    = 3,
+        MtsTable    = 4,
+        BullMtd     = 5,
+        BullMts     = 6,
+        Coordinates = 7
+    };
+
+    static constexpr quint32 Magic = 0x4D534553; // "MSES"
+    static constexpr quint32 FormatVersion = 1;
+
+    // запись всей сессии целиком
+    static bool save(const QString& fileName,
+                     const SessionMeta& meta,
+                     const std::vector<Coordinate>& coordinates,
+                     const std::vector<Zone>& zones,
+                     const std::vector<Mtd>& mtd,
+                     const std::vector<Mts>& mts,
+                     const std::vector<Bull_mtd>& bull_mtd,
+                     const std::vector<Bull_mts>& bull_mts);
+
+    // хэш содержимого файла (пустой массив, если файл не открылся)
+    static QByteArray fileHash(const QString& fileName);
+
+    // чтение: open() читает только заголовок и оглавление
+    bool open(const QString& fileName);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    bool hasSection(Section id) const { return m_sections.count(id) != 0; }
+    QString fileName() const { return m_file.fileName(); }
+
+    bool loadMeta(SessionMeta& meta);
+    bool loadCoordinates(std::vector<Coordinate>& coordinates);
+    bool loadZones(std::vector<Zone>& zones);
+    bool loadMtd(std::vector<Mtd>& mtd);
+    bool loadMts(std::vector<Mts>& mts);
+    bool loadBullMtd(std::vector<Bull_mtd>& records);
+    bool loadBullMts(std::vector<Bull_mts>& records);
+
+private:
+    struct Entry {
+        quint64 offset{};
+        quint64 size{};
+    };
+
+    bool readSection(Section id, QByteArray& data);
+
+    QFile m_file;
+    quint32 m_version{};
+    std::map<quint32, Entry> m_sections;
+};
+
+#endif // SESSIONFILE_H
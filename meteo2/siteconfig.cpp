@@ -0,0 +1,66 @@
+#include "siteconfig.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+double normalGravity(double latitude)
+{
+    const double phi = latitude * M_PI / 180.0;
+    const double s1 = std::sin(phi);
+    const double s2 = std::sin(2 * phi);
+
+    return 9.780327 * (1 + 0.0053024 * s1 * s1 - 0.0000058 * s2 * s2);
+}
+
+GeopotentialProfile::GeopotentialProfile(const SiteConfig& site)
+    : m_site(site)
+{
+    const size_t count = size_t(MaxHeight / Step) + 1;
+
+    m_gravity.resize(count);
+    m_geopotential.resize(count);
+
+    const double g0 = normalGravity(site.latitude);
+    const double R = site.earthRadius;
+    const double r0 = R + site.elevation;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double h = double(i) * Step;
+        const double k = R / (r0 + h);
+
+        m_gravity[i] = g0 * k * k;
+
+        // ∫ g0 (R / (R + z))^2 dz от r0 до r0 + h = g0 R^2 h / (r0 (r0 + h))
+        m_geopotential[i] = g0 * R * R * h / (r0 * (r0 + h)) / gc;
+    }
+}
+
+double GeopotentialProfile::interpolate(const std::vector<double>& table, double h) const
+{
+    // ниже станции и выше таблицы - продолжение крайнего отрезка
+    const double x = h / Step;
+    const size_t last = table.size() - 2;
+    const size_t i = (x <= 0) ? 0 : std::min(size_t(x), last);
+
+    return table[i] + (table[i + 1] - table[i]) * (x - double(i));
+}
+
+std::shared_ptr<const GeopotentialProfile> GeopotentialProfile::forSite(const SiteConfig& site)
+{
+    static QMutex mutex;
+    static std::map<std::tuple<double, double, double>, std::shared_ptr<const GeopotentialProfile>> profiles;
+
+    QMutexLocker locker(&mutex);
+
+    auto& profile = profiles[{site.latitude, site.elevation, site.earthRadius}];
+    if (!profile)
+        profile = std::make_shared<const GeopotentialProfile>(site);
+
+    return profile;
+}
@@ -0,0 +1,55 @@
+#ifndef SITECONFIG_H
+#define SITECONFIG_H
+
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "types.h"
+
+// Место зондирования
+struct SiteConfig {
+    QString name;
+    double latitude = m_latitude;  // широта, градусы
+    double elevation = 0.0;        // высота станции над уровнем моря, м
+    double earthRadius = rzem;     // радиус земли, м
+};
+
+// нормальное ускорение силы тяжести на уровне моря на широте latitude (градусы), м/с2
+double normalGravity(double latitude);
+
+// Профиль силы тяжести и геопотенциала для места зондирования.
+//
+// Таблица считается один раз на место с шагом Step по высоте над станцией:
+//   g(h)  = g(φ) * (R / (R + hs + h))^2,
+//   H'(h) = (1/gc) * ∫ g dz от станции до h,
+// где g(φ) - нормальная сила тяжести на широте, hs - высота станции.
+// Запрос - линейная интерполяция между узлами.
+class GeopotentialProfile
+{
+public:
+    static constexpr double Step = 50.0;         // шаг таблицы, м
+    static constexpr double MaxHeight = 60000.0; // верх таблицы над станцией, м
+
+    explicit GeopotentialProfile(const SiteConfig& site);
+
+    // общий профиль для места: считается при первом запросе
+    static std::shared_ptr<const GeopotentialProfile> forSite(const SiteConfig& site);
+
+    const SiteConfig& site() const { return m_site; }
+
+    // ускорение силы тяжести на высоте h над станцией, м/с2
+    double gravity(double h) const { return interpolate(m_gravity, h); }
+
+    // геопотенциальная высота над станцией для геометрической высоты h
+    double geopotential(double h) const { return interpolate(m_geopotential, h); }
+
+private:
+    double interpolate(const std::vector<double>& table, double h) const;
+
+    SiteConfig m_site;
+    std::vector<double> m_gravity;
+    std::vector<double> m_geopotential;
+};
+
+#endif // SITECONFIG_H
@@ -0,0 +1,279 @@
+#include "siteprofile.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// значение ключа как строка (значения с запятыми QSettings отдает списком)
+QString readString(const QSettings& ini, const QString& key)
+{
+    return ini.value(key).toStringList().join(",").trimmed();
+}
+
+bool readDouble(const QSettings& ini, const QString& key, double& value, QString* error)
+{
+    if (!ini.contains(key))
+        return true;  // остается значение по умолчанию
+
+    bool ok = false;
+    const double v = readString(ini, key).toDouble(&ok);
+    if (!ok)
+    {
+        if (error)
+            *error = "неверное число в " + key;
+        return false;
+    }
+
+    value = v;
+    return true;
+}
+
+bool readLevels(const QSettings& ini, const QString& key, std::vector<double>& levels, QString* error)
+{
+    levels.clear();
+
+    const QStringList items = ini.value(key).toStringList();
+    for (const QString& item : items)
+    {
+        const QString text = item.trimmed();
+        if (text.isEmpty())
+            continue;
+
+        bool ok = false;
+        const double h = text.toDouble(&ok);
+        if (!ok || (!levels.empty() && h <= levels.back()))
+        {
+            if (error)
+                *error = "уровни " + key + " должны быть возрастающими числами";
+            return false;
+        }
+
+        levels.push_back(h);
+    }
+
+    if (levels.empty())
+    {
+        if (error)
+            *error = "не заданы уровни " + key;
+        return false;
+    }
+
+    return true;
+}
+
+bool readTable(QSettings& ini, const QString& group, std::map<double, double>& table, QString* error)
+{
+    table.clear();
+
+    ini.beginGroup(group);
+    const QStringList keys = ini.childKeys();
+
+    for (const QString& key : keys)
+    {
+        bool okH = false;
+        bool okV = false;
+        const double h = key.toDouble(&okH);
+        const double v = readString(ini, key).toDouble(&okV);
+
+        if (!okH || !okV)
+        {
+            if (error)
+                *error = QString("неверная строка таблицы [%1]: %2").arg(group, key);
+            ini.endGroup();
+            return false;
+        }
+
+        table[h] = v;
+    }
+
+    ini.endGroup();
+
+    if (table.empty())
+    {
+        if (error)
+            *error = QString("пустая таблица [%1]").arg(group);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<const SiteProfile> SiteProfile::load(const QString& fileName, QString* error)
+{
+    if (!QFileInfo::exists(fileName))
+    {
+        if (error)
+            *error = "файл не найден";
+        return nullptr;
+    }
+
+    QSettings ini(fileName, QSettings::IniFormat);
+    if (ini.status() != QSettings::NoError)
+    {
+        if (error)
+            *error = "ошибка формата ini";
+        return nullptr;
+    }
+
+    auto profile = std::make_shared<SiteProfile>();
+    profile->id = QFileInfo(fileName).completeBaseName();
+
+    // пропущенные ключи берутся по умолчанию
+    profile->constants = {1.0, 4000.0, 100.0, 32.0, 32.0, 10.0, 51.0, 993.331};
+
+    SiteConfig& site = profile->site;
+    site.name = readString(ini, "site/name");
+    if (site.name.isEmpty())
+        site.name = profile->id;
+
+    double number = profile->station.number;
+    double position1 = 0.0;
+    double position2 = 0.0;
+
+    UserConstants& c = profile->constants;
+
+    const bool ok = readDouble(ini, "site/latitude", site.latitude, error)
+                    && readDouble(ini, "site/elevation", site.elevation, error)
+                    && readDouble(ini, "site/earthRadius", site.earthRadius, error)
+                    && readDouble(ini, "station/number", number, error)
+                    && readDouble(ini, "station/position1", position1, error)
+                    && readDouble(ini, "station/position2", position2, error)
+                    && readDouble(ini, "constants/A", c.A, error)
+                    && readDouble(ini, "constants/B", c.B, error)
+                    && readDouble(ini, "constants/C", c.C, error)
+                    && readDouble(ini, "constants/R1", c.R1, error)
+                    && readDouble(ini, "constants/R2", c.R2, error)
+                    && readDouble(ini, "constants/T0", c.T0, error)
+                    && readDouble(ini, "constants/U0", c.U0, error)
+                    && readDouble(ini, "constants/P0", c.P0, error)
+                    && readLevels(ini, "levels/mtd", profile->mtdLevels, error)
+                    && readLevels(ini, "levels/mts", profile->mtsLevels, error)
+                    && readTable(ini, "temperature", profile->temperatureTable, error)
+                    && readTable(ini, "density", profile->densityTable, error);
+
+    if (!ok)
+        return nullptr;
+
+    if (std::abs(site.latitude) > 90.0 || site.earthRadius <= 0.0)
+    {
+        if (error)
+            *error = "неверная широта или радиус земли";
+        return nullptr;
+    }
+
+    const QString zones = readString(ini, "levels/zones");
+    if (!zones.isEmpty() && !ZoneGrid::parse(zones, profile->zoneGrid, error))
+        return nullptr;
+
+    const QString radiation = readString(ini, "radiation/table");
+    if (!radiation.isEmpty())
+    {
+        auto table = std::make_shared<RadiationTable>();
+        const QString path = QFileInfo(fileName).dir().filePath(radiation);
+
+        if (!table->load(path, error))
+            return nullptr;
+
+        profile->radiationTable = table;
+    }
+
+    profile->station.number = int(number);
+    profile->station.elevation = int(std::lround(site.elevation));
+    profile->station.position = {int(position1), int(position2)};
+
+    return profile;
+}
+
+void SiteProfile::applyTo(PipelineInput& input) const
+{
+    input.site = site;
+    input.constants = constants;
+
+    input.mtdLevels = mtdLevels;
+    input.mtsLevels = mtsLevels;
+    input.zoneGrid = zoneGrid;
+
+    input.temperatureTable = temperatureTable;
+    input.densityTable = densityTable;
+
+    input.radiationTable = radiationTable;
+}
+
+SiteRegistry::SiteRegistry()
+{
+    loadFile(":/sites/default.ini");
+}
+
+bool SiteRegistry::loadFile(const QString& fileName)
+{
+    QString error;
+    SiteProfilePtr profile = SiteProfile::load(fileName, &error);
+
+    if (!profile)
+    {
+        m_errors << fileName + ": " + error;
+        return false;
+    }
+
+    add(std::move(profile));
+    return true;
+}
+
+int SiteRegistry::loadDirectory(const QString& dir)
+{
+    int loaded = 0;
+
+    const QFileInfoList files = QDir(dir).entryInfoList(QStringList() << "*.ini", QDir::Files, QDir::Name);
+    for (const QFileInfo& info : files)
+    {
+        if (loadFile(info.absoluteFilePath()))
+            ++loaded;
+    }
+
+    return loaded;
+}
+
+void SiteRegistry::loadStandardLocations()
+{
+    loadDirectory(QDir(QCoreApplication::applicationDirPath()).filePath("sites"));
+    loadDirectory(QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("sites"));
+}
+
+void SiteRegistry::add(SiteProfilePtr profile)
+{
+    auto it = std::find_if(m_profiles.begin(), m_profiles.end(),
+                           [&](const SiteProfilePtr& p) { return p->id == profile->id; });
+
+    if (it != m_profiles.end())
+        *it = std::move(profile);
+    else
+        m_profiles.push_back(std::move(profile));
+}
+
+SiteProfilePtr SiteRegistry::find(const QString& id) const
+{
+    for (const SiteProfilePtr& profile : m_profiles)
+    {
+        if (profile->id == id)
+            return profile;
+    }
+
+    return nullptr;
+}
+
+SiteProfilePtr SiteRegistry::defaultProfile() const
+{
+    if (SiteProfilePtr profile = find(DefaultId))
+        return profile;
+
+    return m_profiles.empty() ? nullptr : m_profiles.front();
+}
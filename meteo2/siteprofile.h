@@ -0,0 +1,83 @@
+#ifndef SITEPROFILE_H
+#define SITEPROFILE_H
+
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "types.h"
+#include "siteconfig.h"
+#include "zonegrid.h"
+#include "bulletinwriter.h"
+#include "pipeline.h"
+#include "radiationtable.h"
+
+// Профиль места зондирования: все, что раньше было зашито в программу.
+//
+// Читается из ini-файла (см. sites/default.ini) один раз и дальше не
+// меняется, поэтому один объект можно держать одновременно в окне и в
+// пакетной обработке.
+struct SiteProfile {
+    QString id;                         // имя файла без расширения
+    SiteConfig site;
+    BulletinWriter::Station station;
+
+    // константы датчика и наземные значения по умолчанию
+    UserConstants constants{};
+
+    std::vector<double> mtdLevels;
+    std::vector<double> mtsLevels;
+    ZoneGrid zoneGrid = ZoneGrid::standard();
+
+    std::map<double, double> temperatureTable;
+    std::map<double, double> densityTable;
+
+    // таблица радиационных поправок ([radiation] table=, путь от файла профиля)
+    std::shared_ptr<const RadiationTable> radiationTable;
+
+    // nullptr - файл не читается или заполнен неверно (причина в error)
+    static std::shared_ptr<const SiteProfile> load(const QString& fileName, QString* error = nullptr);
+
+    // уровни, таблицы, место и константы профиля во входе расчета
+    void applyTo(PipelineInput& input) const;
+};
+
+using SiteProfilePtr = std::shared_ptr<const SiteProfile>;
+
+// Набор профилей, загруженных при запуске.
+//
+// Встроенный профиль (":/sites/default.ini") есть всегда; файлы из
+// каталогов добавляются по порядку, профиль с тем же id заменяет прежний.
+class SiteRegistry
+{
+public:
+    static constexpr const char* DefaultId = "default";
+
+    SiteRegistry();
+
+    // загрузка *.ini каталога; возвращает число загруженных профилей
+    int loadDirectory(const QString& dir);
+    bool loadFile(const QString& fileName);
+
+    // встроенный профиль и каталоги sites рядом с программой и в данных программы
+    void loadStandardLocations();
+
+    const std::vector<SiteProfilePtr>& profiles() const { return m_profiles; }
+
+    // nullptr - нет такого профиля
+    SiteProfilePtr find(const QString& id) const;
+    SiteProfilePtr defaultProfile() const;
+
+    // файлы, которые не удалось загрузить ("файл: причина")
+    const QStringList& errors() const { return m_errors; }
+
+private:
+    void add(SiteProfilePtr profile);
+
+    std::vector<SiteProfilePtr> m_profiles;
+    QStringList m_errors;
+};
+
+#endif // SITEPROFILE_H
@@ -0,0 +1,61 @@
+#include "trajectory.h"
+
+#include <algorithm>
+
+Trajectory::Trajectory(const std::vector<Coordinate>& coordinates)
+{
+    m_h.reserve(coordinates.size());
+    m_x.reserve(coordinates.size());
+    m_z.reserve(coordinates.size());
+    m_s.reserve(coordinates.size());
+
+    for (const auto& c : coordinates)
+    {
+        if (!m_h.empty() && c.H <= m_h.back())
+            continue;
+
+        m_h.push_back(c.H);
+        m_x.push_back(c.X);
+        m_z.push_back(c.Z);
+        m_s.push_back(c.S);
+    }
+}
+
+Trajectory::Point Trajectory::at(double h) const
+{
+    if (m_h.empty())
+        return {h, 0.0, 0.0, 0.0};
+
+    const size_t last = m_h.size() - 1;
+
+    if (h <= m_h.front())
+        return {h, m_x.front(), m_z.front(), m_s.front()};
+
+    if (h >= m_h[last])
+        return {h, m_x[last], m_z[last], m_s[last]};
+
+    // нужен отрезок m_h[i] <= h < m_h[i + 1]
+    size_t i = std::min(m_cursor, last - 1);
+
+    if (h < m_h[i])
+    {
+        i = size_t(std::upper_bound(m_h.begin(), m_h.begin() + i, h) - m_h.begin()) - 1;
+    }
+    else if (m_h[i + 1] <= h)
+    {
+        // следующий отрезок проверяется сразу, дальше - двоичный поиск
+        // от курсора, чтобы дальний запрос не шел по отсчетам подряд
+        ++i;
+        if (m_h[i + 1] <= h)
+            i = size_t(std::upper_bound(m_h.begin() + i + 1, m_h.end(), h) - m_h.begin()) - 1;
+    }
+
+    m_cursor = i;
+
+    const double k = (h - m_h[i]) / (m_h[i + 1] - m_h[i]);
+
+    return {h,
+            m_x[i] + (m_x[i + 1] - m_x[i]) * k,
+            m_z[i] + (m_z[i + 1] - m_z[i]) * k,
+            m_s[i] + (m_s[i + 1] - m_s[i]) * k};
+}
@@ -0,0 +1,45 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <vector>
+
+#include "types.h"
+
+// Траектория зонда как функция высоты.
+//
+// Строится один раз по координатам: берутся только отсчеты, поднявшиеся
+// выше всех предыдущих, поэтому высота строго возрастает (провалы из-за
+// шума и спуск после разрыва оболочки отбрасываются). X, Z и время между
+// соседними отсчетами интерполируются линейно.
+//
+// Запросы по возрастанию высоты идут курсором - в среднем O(1),
+// произвольный запрос - двоичный поиск.
+class Trajectory
+{
+public:
+    struct Point {
+        double H{};
+        double X{};
+        double Z{};
+        double S{};
+    };
+
+    Trajectory() = default;
+    explicit Trajectory(const std::vector<Coordinate>& coordinates);
+
+    bool isEmpty() const { return m_h.empty(); }
+    size_t size() const { return m_h.size(); }
+
+    // положение на высоте h; вне траектории - крайняя точка
+    Point at(double h) const;
+
+private:
+    std::vector<double> m_h;
+    std::vector<double> m_x;
+    std::vector<double> m_z;
+    std::vector<double> m_s;
+
+    mutable size_t m_cursor = 0;
+};
+
+#endif // TRAJECTORY_H
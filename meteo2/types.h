@@ -79,6 +79,8 @@ struct TemperatureRecord // логи температуры
     double T{};
     double T1{}; // температура + радиационная поправка
     double Tpni{};
+
+    double U{NAN}; // измеренная влажность, % (NaN - в логе нет столбца)
 };
 
 struct UserConstants { // константы для расчета температуры, которые вводит пользователь
@@ -124,6 +126,15 @@ struct Zone {
     double Ri{}; // вертикальная устойчивость
     double T{}; // температура для устойчивости
 
+    // ветер по МНК по всем отсчетам зоны (calculateVkLsq)
+    double vxErr{}; // СКО vx, м/с
+    double vzErr{}; // СКО vz, м/с
+    double nSamples{}; // число отсчетов в зоне
+
+    double Hgeo{}; // геопотенциальная высота границы зоны над станцией
+
+    double Un{NAN}; // средняя измеренная влажность зоны, % (NaN - нет измерений)
+
     Zone() = default;
 
     explicit Zone(double h)
@@ -0,0 +1,188 @@
+#ifndef TYPESIO_H
+#define TYPESIO_H
+
+#include <QDataStream>
+#include <QIODevice>
+#include <iterator>
+#include <vector>
+
+#include "types.h"
+
+// Двоичная запись расчетных структур.
+//
+// Все структуры состоят из double, поэтому каждая описывается таблицей
+// полей. В поток пишется число полей в записи, при чтении лишние поля
+// пропускаются, а недостающие остаются нулевыми. Новые поля добавлять
+// только в конец таблицы - тогда старые файлы продолжают читаться.
+
+template<typename T>
+struct FieldTable;
+
+template<>
+struct FieldTable<Coordinate> {
+    static constexpr double Coordinate::* fields[] = {
+        &Coordinate::X, &Coordinate::Z, &Coordinate::H, &Coordinate::S,
+        &Coordinate::H_geo,
+        &Coordinate::dglob, &Coordinate::aglob, &Coordinate::eglob
+    };
+};
+
+template<>
+struct FieldTable<Zone> {
+    static constexpr double Zone::* fields[] = {
+        &Zone::x, &Zone::z, &Zone::s, &Zone::vx, &Zone::vz, &Zone::dh, &Zone::y,
+        &Zone::height, &Zone::dH, &Zone::Hi, &Zone::Tn,
+        &Zone::TTi, &Zone::TTcpm, &Zone::dTvir, &Zone::Tvrn, &Zone::Ttab,
+        &Zone::Pn, &Zone::Pi, &Zone::Pitab, &Zone::PPi, &Zone::PPcpm,
+        &Zone::Ri, &Zone::T,
+        &Zone::vxErr, &Zone::vzErr, &Zone::nSamples,
+        &Zone::Hgeo,
+        &Zone::Un
+    };
+};
+
+template<>
+struct FieldTable<Mtd> {
+    static constexpr double Mtd::* fields[] = {
+        &Mtd::h, &Mtd::y_prev, &Mtd::y_next, &Mtd::vx, &Mtd::vz, &Mtd::v, &Mtd::av, &Mtd::dh,
+        &Mtd::TTi, &Mtd::TTcpm, &Mtd::PPi, &Mtd::PPcpm
+    };
+};
+
+template<>
+struct FieldTable<Mts> {
+    static constexpr double Mts::* fields[] = {
+        &Mts::h, &Mts::y_prev, &Mts::y_next, &Mts::vx, &Mts::vz,
+        &Mts::wx, &Mts::wz, &Mts::w, &Mts::aw, &Mts::dh,
+        &Mts::TTi, &Mts::TTcpm, &Mts::PPi, &Mts::PPcpm
+    };
+};
+
+template<>
+struct FieldTable<Bull_mtd> {
+    static constexpr double Bull_mtd::* fields[] = {
+        &Bull_mtd::h, &Bull_mtd::PPi, &Bull_mtd::TTi, &Bull_mtd::v, &Bull_mtd::av
+    };
+};
+
+template<>
+struct FieldTable<Bull_mts> {
+    static constexpr double Bull_mts::* fields[] = {
+        &Bull_mts::h, &Bull_mts::w, &Bull_mts::aw, &Bull_mts::TTcpm, &Bull_mts::PPcpm
+    };
+};
+
+template<>
+struct FieldTable<UserConstants> {
+    static constexpr double UserConstants::* fields[] = {
+        &UserConstants::A, &UserConstants::B, &UserConstants::C,
+        &UserConstants::R1, &UserConstants::R2,
+        &UserConstants::T0, &UserConstants::U0, &UserConstants::P0
+    };
+};
+
+template<>
+struct FieldTable<TemperatureRecord> {
+    // index хранится отдельно (см. writeRecords/readRecords)
+    static constexpr double TemperatureRecord::* fields[] = {
+        &TemperatureRecord::QO, &TemperatureRecord::QT, &TemperatureRecord::dtp,
+        &TemperatureRecord::U0, &TemperatureRecord::T0, &TemperatureRecord::P0,
+        &TemperatureRecord::dtv, &TemperatureRecord::Yt, &TemperatureRecord::Rt,
+        &TemperatureRecord::T, &TemperatureRecord::T1, &TemperatureRecord::Tpni,
+        &TemperatureRecord::U
+    };
+};
+
+template<typename T>
+void writeRecord(QDataStream& out, const T& item)
+{
+    for (auto field : FieldTable<T>::fields)
+        out << item.*field;
+}
+
+template<typename T>
+void readRecord(QDataStream& in, T& item, quint32 storedFields)
+{
+    constexpr quint32 known = std::size(FieldTable<T>::fields);
+
+    for (quint32 i = 0; i < storedFields; ++i)
+    {
+        double value{};
+        in >> value;
+
+        if (i < known)
+            item.*(FieldTable<T>::fields[i]) = value;
+    }
+}
+
+template<typename T>
+void writeVector(QDataStream& out, const std::vector<T>& items)
+{
+    out << quint32(std::size(FieldTable<T>::fields));
+    out << quint64(items.size());
+
+    for (const auto& item : items)
+        writeRecord(out, item);
+}
+
+template<typename T>
+bool readVector(QDataStream& in, std::vector<T>& items)
+{
+    quint32 storedFields{};
+    quint64 count{};
+
+    in >> storedFields >> count;
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    // защита от испорченного счетчика записей
+    if (in.device())
+    {
+        quint64 left = quint64(in.device()->size() - in.device()->pos());
+        if (count * storedFields * sizeof(double) > left)
+            return false;
+    }
+
+    items.clear();
+    items.resize(count);
+
+    for (auto& item : items)
+        readRecord(in, item, storedFields);
+
+    return in.status() == QDataStream::Ok;
+}
+
+// записи температуры: столбец индексов зон, затем поля double
+inline void writeRecords(QDataStream& out, const std::vector<TemperatureRecord>& records)
+{
+    out << quint64(records.size());
+    for (const auto& r : records)
+        out << qint32(r.index);
+
+    writeVector(out, records);
+}
+
+inline bool readRecords(QDataStream& in, std::vector<TemperatureRecord>& records)
+{
+    quint64 count{};
+    in >> count;
+
+    std::vector<qint32> indexes;
+    for (quint64 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        qint32 index{};
+        in >> index;
+        indexes.push_back(index);
+    }
+
+    if (!readVector(in, records) || records.size() != indexes.size())
+        return false;
+
+    for (size_t i = 0; i < records.size(); ++i)
+        records[i].index = indexes[i];
+
+    return true;
+}
+
+#endif // TYPESIO_H
@@ -0,0 +1,42 @@
+#include "virtualcorrection.h"
+
+#include <cmath>
+
+VirtualCorrection::VirtualCorrection(const UserConstants& surface)
+    : m_T0(surface.T0),
+    m_P0(surface.P0)
+{
+    m_k = 2.3 * surface.U0 / (100 * surface.P0)
+          * std::exp(((310 * surface.T0) - surface.T0 * surface.T0) / 4300);
+}
+
+double VirtualCorrection::at(double tn, double height) const
+{
+    const double Hkm = height / 1000.0;
+    return m_k * (tn + 273.15) * std::exp(-2.3 * (0.0947 * Hkm + 0.0138 * Hkm * Hkm));
+}
+
+double VirtualCorrection::saturationPressure(double t)
+{
+    return 6.1078 * std::exp(17.27 * t / (t + 237.3));
+}
+
+double VirtualCorrection::measured(double tn, double u, double height) const
+{
+    const double T = tn + 273.15;
+
+    // изотермическая оценка давления по температуре зоны
+    const double p = m_P0 * std::exp(-height / (29.27 * T));
+    const double e = 0.378 * (u / 100.0) * saturationPressure(tn);
+
+    return T * e / (p - e);
+}
+
+void VirtualCorrection::apply(std::vector<Zone>& zones) const
+{
+    for (size_t i = 1; i < zones.size(); ++i)
+    {
+        const Zone& zone = zones[i];
+        zones[i].dTvir = std::isnan(zone.Un) ? at(zone.Tn, zone.Hi) : measured(zone.Tn, zone.Un, zone.Hi);
+    }
+}
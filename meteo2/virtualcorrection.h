@@ -0,0 +1,47 @@
+#ifndef VIRTUALCORRECTION_H
+#define VIRTUALCORRECTION_H
+
+#include <vector>
+
+#include "types.h"
+
+// Виртуальная поправка ΔTv зон для одних наземных условий (T0, U0, P0).
+//
+// ΔTv(Tn, H) = k * (Tn + 273.15) * exp(-2.3 * (0.0947 H + 0.0138 H^2)), H в км,
+// где k = 2.3 U0 / (100 P0) * exp((310 T0 - T0^2) / 4300) зависит только от
+// наземных значений и считается один раз. На земле (H = 0, Tn = T0) это
+// наземная поправка ΔTv0.
+//
+// Если в зоне есть измеренная влажность Un, поправка считается по ней:
+//   e = Un/100 * 6.1078 * exp(17.27 t / (t + 237.3))  (Магнус, гПа),
+//   ΔTv = (t + 273.15) * 0.378 e / (p - 0.378 e),
+// где p - давление середины зоны, оцененное от P0 по температуре зоны.
+class VirtualCorrection
+{
+public:
+    explicit VirtualCorrection(const UserConstants& surface);
+
+    // наземная поправка ΔTv0 и виртуальная температура у земли
+    double ground() const { return m_k * (m_T0 + 273.15); }
+    double groundTemperature() const { return m_T0 + ground(); }
+
+    // поправка для температуры tn на высоте height, м
+    double at(double tn, double height) const;
+
+    // поправка по измеренной влажности u, % на высоте height, м
+    double measured(double tn, double u, double height) const;
+
+    // dTvir зон по средней высоте Hi: по Un, где она измерена, иначе по
+    // наземным значениям (нулевая зона - у земли - не меняется)
+    void apply(std::vector<Zone>& zones) const;
+
+    // давление насыщенного пара над водой при t, °C, гПа
+    static double saturationPressure(double t);
+
+private:
+    double m_T0;
+    double m_P0;
+    double m_k;
+};
+
+#endif // VIRTUALCORRECTION_H
@@ -0,0 +1,85 @@
+#include "zonegrid.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+size_t ZoneGrid::count() const
+{
+    size_t count = 0;
+    for (const auto& band : m_bands)
+        count += ZoneLayouts::bandCount(band);
+    return count;
+}
+
+bool ZoneGrid::isStandard() const
+{
+    const auto& standard = ZoneLayouts::Standard;
+
+    return std::equal(m_bands.begin(), m_bands.end(), standard.begin(), standard.end(),
+                      [](const ZoneBand& a, const ZoneBand& b)
+                      {
+                          return a.from == b.from && a.to == b.to && a.step == b.step;
+                      });
+}
+
+bool ZoneGrid::parse(const QString& spec, ZoneGrid& grid, QString* error)
+{
+    auto fail = [&](const QString& message)
+    {
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    std::vector<ZoneBand> bands;
+
+    const QStringList parts = spec.split(',', Qt::SkipEmptyParts);
+    for (const QString& part : parts)
+    {
+        // от-до:шаг
+        const QStringList rangeStep = part.trimmed().split(':');
+        if (rangeStep.size() != 2)
+            return fail(QString("Ожидается \"от-до:шаг\": %1").arg(part.trimmed()));
+
+        const QStringList range = rangeStep[0].split('-');
+        if (range.size() != 2)
+            return fail(QString("Ожидается \"от-до:шаг\": %1").arg(part.trimmed()));
+
+        bool okFrom = false, okTo = false, okStep = false;
+        ZoneBand band{range[0].trimmed().toInt(&okFrom),
+                      range[1].trimmed().toInt(&okTo),
+                      rangeStep[1].trimmed().toInt(&okStep)};
+
+        if (!okFrom || !okTo || !okStep)
+            return fail(QString("Высоты и шаг задаются целыми метрами: %1").arg(part.trimmed()));
+
+        if (band.from < 0 || band.from >= band.to || band.step <= 0)
+            return fail(QString("Неверная полоса: %1").arg(part.trimmed()));
+
+        // вторая зона на нулевой высоте дала бы зону нулевой толщины
+        if (band.from == 0)
+            return fail(QString("Нулевая зона берется из лога, полоса должна начинаться выше 0: %1")
+                            .arg(part.trimmed()));
+
+        if (!bands.empty() && band.from < bands.back().to)
+            return fail(QString("Полосы перекрываются: %1").arg(part.trimmed()));
+
+        bands.push_back(band);
+    }
+
+    if (bands.empty())
+        return fail("Сетка зон не задана");
+
+    grid.m_bands = std::move(bands);
+    return true;
+}
+
+QString ZoneGrid::toString() const
+{
+    QStringList parts;
+    for (const auto& band : m_bands)
+        parts << QString("%1-%2:%3").arg(band.from).arg(band.to).arg(band.step);
+
+    return parts.join(", ");
+}
@@ -0,0 +1,102 @@
+#ifndef ZONEGRID_H
+#define ZONEGRID_H
+
+#include <QString>
+#include <array>
+#include <vector>
+
+// Полоса высот [from, to) с шагом step, метры
+struct ZoneBand {
+    int from;
+    int to;
+    int step;
+};
+
+namespace ZoneLayouts {
+
+// Стандартная сетка зон для расчета по логу ветра
+// (нулевая зона берется из первой строки лога)
+constexpr std::array<ZoneBand, 4> Standard = {{
+    {100,   500,   100},
+    {600,   6000,  200},
+    {6000,  14000, 400},
+    {14000, 20000, 500},
+}};
+
+// Расширенная сетка до 50 км с нулевой зоной
+constexpr std::array<ZoneBand, 4> Extended = {{
+    {0,     500,   100},
+    {600,   6000,  200},
+    {6000,  14000, 400},
+    {14000, 50001, 500},
+}};
+
+// число зон в полосе
+constexpr size_t bandCount(const ZoneBand& band)
+{
+    return (band.step > 0 && band.from < band.to)
+               ? size_t((band.to - band.from + band.step - 1) / band.step)
+               : 0;
+}
+
+template<size_t N>
+constexpr size_t layoutCount(const std::array<ZoneBand, N>& bands)
+{
+    size_t count = 0;
+    for (const auto& band : bands)
+        count += bandCount(band);
+    return count;
+}
+
+static_assert(layoutCount(Standard) == 63, "стандартная сетка: 63 зоны");
+static_assert(layoutCount(Extended) == 125, "расширенная сетка: 125 зон");
+
+} // namespace ZoneLayouts
+
+// Сетка зон: список полос высот. Высоты считаются в целых метрах
+// (from + k * step), поэтому ошибка округления не накапливается.
+class ZoneGrid
+{
+public:
+    ZoneGrid() = default;
+
+    template<size_t N>
+    explicit ZoneGrid(const std::array<ZoneBand, N>& bands)
+        : m_bands(bands.begin(), bands.end())
+    {
+    }
+
+    static ZoneGrid standard() { return ZoneGrid(ZoneLayouts::Standard); }
+    static ZoneGrid extended() { return ZoneGrid(ZoneLayouts::Extended); }
+
+    // Разбор описания вида "50-2000:50, 2000-20000:100" (от-до:шаг, метры).
+    // Полосы должны идти по возрастанию и не перекрываться. Нулевая зона
+    // берется из первой строки лога, поэтому высоты сетки - выше нуля.
+    static bool parse(const QString& spec, ZoneGrid& grid, QString* error = nullptr);
+
+    QString toString() const;
+
+    const std::vector<ZoneBand>& bands() const { return m_bands; }
+    bool isStandard() const;
+    bool isEmpty() const { return m_bands.empty(); }
+
+    // общее число зон
+    size_t count() const;
+
+    // вызывает f(h) для каждой высоты сетки по возрастанию
+    template<typename F>
+    void forEachHeight(F f) const
+    {
+        for (const auto& band : m_bands)
+        {
+            const size_t n = ZoneLayouts::bandCount(band);
+            for (size_t k = 0; k < n; ++k)
+                f(double(band.from + int(k) * band.step));
+        }
+    }
+
+private:
+    std::vector<ZoneBand> m_bands;
+};
+
+#endif // ZONEGRID_H
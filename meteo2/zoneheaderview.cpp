@@ -0,0 +1,119 @@
+#include "zoneheaderview.h"
+#include "zonetablemodel.h"
+
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QPainter>
+#include <QPainterPath>
+
+#include <cmath>
+
+ZoneHeaderView::ZoneHeaderView(QWidget* parent)
+    : QHeaderView(Qt::Horizontal, parent)
+{
+    setDefaultAlignment(Qt::AlignHCenter | Qt::AlignTop);
+    setSectionsClickable(true);
+    setSortIndicatorShown(true);
+}
+
+QStringList ZoneHeaderView::visibleColumns() const
+{
+    QStringList names;
+    if (!model())
+        return names;
+
+    for (int i = 0; i < count(); ++i)
+    {
+        if (!isSectionHidden(i))
+            names << model()->headerData(i, orientation()).toString();
+    }
+
+    return names;
+}
+
+void ZoneHeaderView::setVisibleColumns(const QStringList& names)
+{
+    if (!model() || names.isEmpty())
+        return;
+
+    for (int i = 0; i < count(); ++i)
+        setSectionHidden(i, !names.contains(model()->headerData(i, orientation()).toString()));
+}
+
+void ZoneHeaderView::paintSection(QPainter* painter, const QRect& rect, int logicalIndex) const
+{
+    painter->save();
+    QHeaderView::paintSection(painter, rect, logicalIndex);
+    painter->restore();
+
+    if (!model())
+        return;
+
+    const QList<double> points = model()->headerData(logicalIndex, orientation(),
+                                                     ZoneTableModel::SparklineRole).value<QList<double>>();
+    if (points.size() < 2)
+        return;
+
+    const QRectF area = QRectF(rect).adjusted(4, rect.height() - SparklineHeight - 3, -4, -3);
+    const double step = area.width() / (points.size() - 1);
+
+    // пропуски (NaN) рвут линию
+    QPainterPath path;
+    bool penUp = true;
+    for (int i = 0; i < points.size(); ++i)
+    {
+        if (std::isnan(points[i]))
+        {
+            penUp = true;
+            continue;
+        }
+
+        const QPointF p(area.left() + step * i, area.bottom() - area.height() * points[i]);
+        if (penUp)
+            path.moveTo(p);
+        else
+            path.lineTo(p);
+        penUp = false;
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(QPen(palette().color(QPalette::Highlight), 1));
+    painter->drawPath(path);
+    painter->restore();
+}
+
+QSize ZoneHeaderView::sectionSizeFromContents(int logicalIndex) const
+{
+    QSize size = QHeaderView::sectionSizeFromContents(logicalIndex);
+    size.setHeight(size.height() + SparklineHeight + 4);
+    return size;
+}
+
+void ZoneHeaderView::contextMenuEvent(QContextMenuEvent* event)
+{
+    if (!model())
+        return;
+
+    QMenu menu(this);
+    for (int i = 0; i < count(); ++i)
+    {
+        QAction* action = menu.addAction(model()->headerData(i, orientation()).toString());
+        action->setToolTip(model()->headerData(i, orientation(), Qt::ToolTipRole).toString());
+        action->setCheckable(true);
+        action->setChecked(!isSectionHidden(i));
+        action->setData(i);
+    }
+    menu.setToolTipsVisible(true);
+
+    QAction* chosen = menu.exec(event->globalPos());
+    if (!chosen)
+        return;
+
+    // последний видимый столбец не скрывается
+    if (!chosen->isChecked() && count() - hiddenSectionCount() <= 1)
+        return;
+
+    setSectionHidden(chosen->data().toInt(), !chosen->isChecked());
+    emit visibleColumnsChanged();
+}
@@ -0,0 +1,35 @@
+#ifndef ZONEHEADERVIEW_H
+#define ZONEHEADERVIEW_H
+
+#include <QHeaderView>
+#include <QStringList>
+
+// Заголовок таблицы зон.
+//
+// Под именем столбца рисуется его профиль по зонам снизу вверх
+// (ZoneTableModel::SparklineRole), по правому щелчку - выбор видимых
+// столбцов.
+class ZoneHeaderView : public QHeaderView
+{
+    Q_OBJECT
+
+public:
+    static constexpr int SparklineHeight = 18;
+
+    explicit ZoneHeaderView(QWidget* parent = nullptr);
+
+    // имена видимых столбцов в порядке модели
+    QStringList visibleColumns() const;
+    // столбцы не из списка скрываются; пустой список - ничего не меняется
+    void setVisibleColumns(const QStringList& names);
+
+signals:
+    void visibleColumnsChanged();
+
+protected:
+    void paintSection(QPainter* painter, const QRect& rect, int logicalIndex) const override;
+    QSize sectionSizeFromContents(int logicalIndex) const override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+};
+
+#endif // ZONEHEADERVIEW_H
@@ -0,0 +1,294 @@
+#include "zonetablemodel.h"
+
+#include <QBrush>
+#include <QColor>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+
+struct ColumnInfo {
+    double Zone::* field;
+    const char* name;
+    const char* description;
+    int decimals;
+    bool visible;
+};
+
+// порядок столбцов - по ходу расчета: геометрия, ветер, температура,
+// давление и плотность, устойчивость
+const ColumnInfo Columns[] = {
+    {&Zone::height,   "height",   "Нижняя граница зоны, м",                     0, true},
+    {&Zone::Hgeo,     "Hgeo",     "Геопотенциальная высота границы, м",         0, false},
+    {&Zone::dH,       "dH",       "Толщина зоны, м",                            0, false},
+    {&Zone::Hi,       "Hi",       "Средняя высота зоны, м",                     0, true},
+    {&Zone::x,        "x",        "Координата X границы, м",                    0, false},
+    {&Zone::z,        "z",        "Координата Z границы, м",                    0, false},
+    {&Zone::s,        "s",        "Время прохождения границы, с",               1, false},
+    {&Zone::dh,       "dh",       "dh",                                         2, false},
+    {&Zone::y,        "y",        "y",                                          2, false},
+    {&Zone::vx,       "vx",       "Составляющая ветра Vx, м/с",                 2, true},
+    {&Zone::vz,       "vz",       "Составляющая ветра Vz, м/с",                 2, true},
+    {&Zone::vxErr,    "vxErr",    "СКО Vx, м/с",                                2, false},
+    {&Zone::vzErr,    "vzErr",    "СКО Vz, м/с",                                2, false},
+    {&Zone::nSamples, "nSamples", "Число отсчетов ветра в зоне",                0, false},
+    {&Zone::Tn,       "Tn",       "Температура зоны, °C",                       2, true},
+    {&Zone::Un,       "Un",       "Измеренная влажность зоны, %",               1, false},
+    {&Zone::dTvir,    "dTvir",    "Виртуальная поправка, °C",                   2, true},
+    {&Zone::Tvrn,     "Tvrn",     "Виртуальная температура зоны, °C",           2, true},
+    {&Zone::Ttab,     "Ttab",     "Табличная температура, °C",                  2, true},
+    {&Zone::TTi,      "TTi",      "Отклонение температуры, °C",                 2, true},
+    {&Zone::TTcpm,    "TTcpm",    "Среднее отклонение температуры, °C",         2, false},
+    {&Zone::Pn,       "Pn",       "Давление на верхней границе зоны, гПа",      1, true},
+    {&Zone::Pi,       "Pi",       "Плотность зоны, кг/м3",                      4, true},
+    {&Zone::Pitab,    "Pitab",    "Табличная плотность, кг/м3",                 4, false},
+    {&Zone::PPi,      "PPi",      "Отклонение плотности, %",                    2, true},
+    {&Zone::PPcpm,    "PPcpm",    "Среднее отклонение плотности, %",            2, false},
+    {&Zone::T,        "T",        "Средняя температура пары зон для Ri, К",     2, false},
+    {&Zone::Ri,       "Ri",       "Число Ричардсона",                           2, true},
+};
+
+constexpr int ColumnCount = int(std::size(Columns));
+
+}
+
+ZoneTableModel::ZoneTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void ZoneTableModel::setZones(const std::vector<Zone>& zones)
+{
+    beginResetModel();
+    m_zones = zones;
+    m_sparklines.clear();
+    endResetModel();
+}
+
+const std::vector<Zone>& ZoneTableModel::zones() const
+{
+    return m_zones;
+}
+
+QString ZoneTableModel::columnName(int column)
+{
+    if (column < 0 || column >= ColumnCount)
+        return QString();
+
+    return QString(Columns[column].name);
+}
+
+int ZoneTableModel::columnByName(const QString& name)
+{
+    for (int c = 0; c < ColumnCount; ++c)
+    {
+        if (name == Columns[c].name)
+            return c;
+    }
+
+    return -1;
+}
+
+QStringList ZoneTableModel::defaultColumns()
+{
+    QStringList names;
+    for (const ColumnInfo& column : Columns)
+    {
+        if (column.visible)
+            names << column.name;
+    }
+
+    return names;
+}
+
+bool ZoneTableModel::isUnstable(const Zone& zone)
+{
+    // NaN не меньше порога - нулевая зона не отмечается
+    return zone.Ri < CriticalRi;
+}
+
+int ZoneTableModel::unstableCount() const
+{
+    int count = 0;
+    for (const Zone& zone : zones())
+        count += isUnstable(zone) ? 1 : 0;
+
+    return count;
+}
+
+int ZoneTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(zones().size());
+}
+
+int ZoneTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ZoneTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= ColumnCount)
+        return QVariant();
+
+    const Zone& zone = zones()[index.row()];
+    const ColumnInfo& column = Columns[index.column()];
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    {
+        const double v = zone.*column.field;
+        if (!std::isfinite(v))
+            return QString();
+        return QString::number(v, 'f', column.decimals);
+    }
+
+    case ValueRole:
+        return zone.*column.field;
+
+    case Qt::TextAlignmentRole:
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+
+    case Qt::BackgroundRole:
+        if (isUnstable(zone))
+            return QBrush(QColor(255, 215, 215));
+        return QVariant();
+
+    case Qt::ToolTipRole:
+        if (isUnstable(zone))
+            return QString("Ri = %1 < %2: слой неустойчив").arg(zone.Ri, 0, 'f', 2).arg(CriticalRi);
+        return QVariant();
+    }
+
+    return QVariant();
+}
+
+QVariant ZoneTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Vertical)
+        return role == Qt::DisplayRole ? QVariant(section) : QVariant();
+
+    if (section < 0 || section >= ColumnCount)
+        return QVariant();
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return QString(Columns[section].name);
+    case Qt::ToolTipRole:
+        return QString(Columns[section].description);
+    case SparklineRole:
+        return QVariant::fromValue(sparkline(section));
+    }
+
+    return QVariant();
+}
+
+QList<double> ZoneTableModel::sparkline(int column) const
+{
+    if (m_sparklines.empty())
+        m_sparklines.resize(ColumnCount);
+
+    QList<double>& points = m_sparklines[column];
+    const std::vector<Zone>& all = zones();
+
+    if (!points.isEmpty() || all.empty())
+        return points;
+
+    double Zone::* field = Columns[column].field;
+
+    // средние по корзинам зон подряд, затем - доли от размаха
+    const int n = std::min<int>(SparklinePoints, int(all.size()));
+    double lo = INFINITY;
+    double hi = -INFINITY;
+
+    points.reserve(n);
+    for (int k = 0; k < n; ++k)
+    {
+        const size_t begin = all.size() * k / n;
+        const size_t end = all.size() * (k + 1) / n;
+
+        double sum = 0;
+        int count = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const double v = all[i].*field;
+            if (std::isfinite(v))
+            {
+                sum += v;
+                ++count;
+            }
+        }
+
+        const double mean = count ? sum / count : NAN;
+        if (count)
+        {
+            lo = std::min(lo, mean);
+            hi = std::max(hi, mean);
+        }
+
+        points.append(mean);
+    }
+
+    const double range = hi - lo;
+    for (double& v : points)
+        v = (range > 0) ? (v - lo) / range : 0.5;
+
+    return points;
+}
+
+bool ZoneTableModel::exportCsv(const QString& fileName, const std::vector<int>& columns) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QByteArray out;
+
+    QStringList header;
+    for (int c : columns)
+        header << Columns[c].name;
+    header << "unstable";
+    out += header.join(',').toUtf8() + "\n";
+
+    for (const Zone& zone : zones())
+    {
+        QStringList row;
+        for (int c : columns)
+        {
+            const double v = zone.*Columns[c].field;
+            row << (std::isfinite(v) ? QString::number(v, 'f', Columns[c].decimals) : QString());
+        }
+        row << (isUnstable(zone) ? "1" : "0");
+        out += row.join(',').toUtf8() + "\n";
+    }
+
+    file.write(out);
+
+    return file.commit();
+}
+
+ZoneSortModel::ZoneSortModel(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+    setSortRole(ZoneTableModel::ValueRole);
+}
+
+bool ZoneSortModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    const double a = left.data(ZoneTableModel::ValueRole).toDouble();
+    const double b = right.data(ZoneTableModel::ValueRole).toDouble();
+
+    if (std::isnan(a) || std::isnan(b))
+    {
+        // NaN "больше" всех при возрастании и "меньше" всех при убывании
+        const bool descending = sortOrder() == Qt::DescendingOrder;
+        return std::isnan(a) == descending && std::isnan(a) != std::isnan(b);
+    }
+
+    return a < b;
+}
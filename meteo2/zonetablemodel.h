@@ -0,0 +1,86 @@
+#ifndef ZONETABLEMODEL_H
+#define ZONETABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+#include "types.h"
+
+// Таблица рассчитанных зон для вкладки "Зоны".
+//
+// Строка - зона, столбец - поле Zone (все поля, см. Columns в .cpp).
+// Модель хранит свою копию зон: вектор окна может очищаться и
+// заполняться заново, не ломая строки сортировки; после пересчета
+// зоны передаются в setZones(). Слои с Ri ниже критического
+// подсвечиваются.
+class ZoneTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // ниже - слой динамически неустойчив (турбулентность)
+    static constexpr double CriticalRi = 0.25;
+
+    enum Role {
+        // значение ячейки числом - для сортировки (NaN - пустая ячейка)
+        ValueRole = Qt::UserRole,
+        // заголовок столбца: профиль столбца, не больше SparklinePoints
+        // значений в долях от минимума до максимума (NaN - нет данных)
+        SparklineRole
+    };
+
+    static constexpr int SparklinePoints = 48;
+
+    explicit ZoneTableModel(QObject* parent = nullptr);
+
+    // копия зон со сбросом модели
+    void setZones(const std::vector<Zone>& zones);
+
+    const std::vector<Zone>& zones() const;
+
+    // имя поля столбца и столбец по имени (-1 - нет такого)
+    static QString columnName(int column);
+    static int columnByName(const QString& name);
+
+    // столбцы, видимые по умолчанию
+    static QStringList defaultColumns();
+
+    // Ri < CriticalRi; у нулевой зоны Ri нет
+    static bool isUnstable(const Zone& zone);
+    int unstableCount() const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // CSV с заданными столбцами и строкой заголовков; последний столбец -
+    // признак неустойчивости (0/1)
+    bool exportCsv(const QString& fileName, const std::vector<int>& columns) const;
+
+private:
+    QList<double> sparkline(int column) const;
+
+    std::vector<Zone> m_zones;
+
+    // профили столбцов, строятся при первой отрисовке заголовка
+    mutable std::vector<QList<double>> m_sparklines;
+};
+
+// Сортировка таблицы зон по числовому значению; пустые (NaN) - в конце
+// при любом направлении сортировки.
+class ZoneSortModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit ZoneSortModel(QObject* parent = nullptr);
+
+protected:
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+};
+
+#endif // ZONETABLEMODEL_H